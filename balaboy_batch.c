@@ -0,0 +1,377 @@
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gb.h"
+
+// Runs many ROM sessions headless, one console per worker thread.
+//
+// Manifest, one job per line ('#' starts a comment):
+//         <rom_path> <input_script_path or -> <frame_nb>
+// Input script, one key state per line, held from the given frame on:
+//         <frame> <keys: comma separated up,down,left,right,a,b,start,select or ->
+
+#define LINE_SIZE       1024
+#define FNV_OFFSET      0xcbf29ce484222325ULL
+#define FNV_PRIME       0x100000001b3ULL
+
+struct batch_input {
+	uint32_t frame;
+	struct input_keys keys;
+};
+
+struct batch_job {
+	char rom[LINE_SIZE];
+	char script[LINE_SIZE];
+	uint32_t frame_nb;
+
+	// results
+	int status;
+	uint64_t ram_hash;
+	uint64_t fb_hash;
+	double fps;
+};
+
+// Jobs of a worker: the owner takes them from the tail, idle workers steal
+// them from the head
+struct batch_deque {
+	pthread_mutex_t lock;
+	uint32_t *jobs;
+	uint32_t head;
+	uint32_t tail;
+};
+
+struct batch_worker {
+	pthread_t thread;
+	uint32_t id;
+	struct batch_deque deque;
+};
+
+static struct batch_job *jobs;
+static uint32_t job_nb;
+static struct batch_worker *workers;
+static uint32_t worker_nb;
+
+static uint64_t hash_fnv1a(uint64_t hash, uint8_t *data, uint32_t size)
+{
+	for (uint32_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+static double time_get_sec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int batch_parse_keys(char *str, struct input_keys *keys)
+{
+	char *save;
+
+	memset(keys, 0, sizeof(*keys));
+	if (!strcmp(str, "-"))
+		return 0;
+
+	for (char *key = strtok_r(str, ",", &save); key;
+	     key = strtok_r(NULL, ",", &save)) {
+		if (!strcmp(key, "up"))
+			keys->up = 1;
+		else if (!strcmp(key, "down"))
+			keys->down = 1;
+		else if (!strcmp(key, "left"))
+			keys->left = 1;
+		else if (!strcmp(key, "right"))
+			keys->right = 1;
+		else if (!strcmp(key, "a"))
+			keys->A = 1;
+		else if (!strcmp(key, "b"))
+			keys->B = 1;
+		else if (!strcmp(key, "start"))
+			keys->start = 1;
+		else if (!strcmp(key, "select"))
+			keys->select = 1;
+		else
+			return -EINVAL;
+	}
+	return 0;
+}
+
+static int batch_load_script(char *path, struct batch_input **inputs,
+			     uint32_t *input_nb)
+{
+	char line[LINE_SIZE], keys[LINE_SIZE];
+	struct batch_input *tmp;
+	uint32_t frame;
+	FILE *fd;
+
+	*inputs = NULL;
+	*input_nb = 0;
+	if (!strcmp(path, "-"))
+		return 0;
+
+	fd = fopen(path, "r");
+	if (!fd) {
+		printf("failed to open input script '%s'\n", path);
+		return -EINVAL;
+	}
+
+	while (fgets(line, LINE_SIZE, fd)) {
+		if (line[0] == '#' || sscanf(line, "%u %1023s", &frame, keys) != 2)
+			continue;
+
+		tmp = realloc(*inputs, (*input_nb + 1) * sizeof(**inputs));
+		if (!tmp) {
+			fclose(fd);
+			return -ENOMEM;
+		}
+		*inputs = tmp;
+		(*inputs)[*input_nb].frame = frame;
+		if (batch_parse_keys(keys, &(*inputs)[*input_nb].keys) < 0) {
+			printf("invalid keys '%s' in input script '%s'\n", keys,
+			       path);
+			fclose(fd);
+			return -EINVAL;
+		}
+		(*input_nb)++;
+	}
+
+	fclose(fd);
+	return 0;
+}
+
+static int batch_run_job(struct gb *gb, struct batch_job *job)
+{
+	struct batch_input *inputs;
+	uint32_t input_nb, input_idx = 0;
+	uint32_t cycles, frame;
+	double start;
+	int ret;
+
+	gb_reset(gb);
+
+	ret = batch_load_script(job->script, &inputs, &input_nb);
+	if (ret < 0)
+		goto exit;
+
+	ret = mem_load_rom(gb, job->rom);
+	if (ret < 0)
+		goto exit;
+
+	gb_init(gb);
+
+	start = time_get_sec();
+	while ((frame = gpu_get_frame_cpt(gb)) < job->frame_nb) {
+		while (input_idx < input_nb && inputs[input_idx].frame <= frame)
+			input_set_keys(gb, &inputs[input_idx++].keys);
+
+		cycles = cpu_run(gb, sched_get_cycles_to_event(gb));
+
+		// Stopped: time still runs so that the script can wake it up
+		if (cpu_get_state(gb) == CPU_STOPPED && !cycles)
+			cycles = sched_get_cycles_to_event(gb);
+
+		sched_advance(gb, cycles);
+	}
+	if (job->frame_nb)
+		job->fps = job->frame_nb / (time_get_sec() - start);
+
+	job->ram_hash = hash_fnv1a(FNV_OFFSET, &gb->mem.memory[0xC000], 0x2000);
+	job->ram_hash = hash_fnv1a(job->ram_hash, &gb->mem.memory[0xFF80], 0x7F);
+
+	// last frame
+	job->fb_hash = hash_fnv1a(FNV_OFFSET, gb->gpu.framebuffer,
+				  sizeof(gb->gpu.framebuffer));
+
+exit:
+	free(inputs);
+	job->status = ret;
+	return ret;
+}
+
+static int batch_pop(struct batch_deque *deque, uint32_t *job)
+{
+	int ret = 0;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		*job = deque->jobs[--deque->tail];
+		ret = 1;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return ret;
+}
+
+static int batch_steal(struct batch_deque *deque, uint32_t *job)
+{
+	int ret = 0;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		*job = deque->jobs[deque->head++];
+		ret = 1;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return ret;
+}
+
+// Own jobs first, then the ones of the other workers. No job is ever added:
+// once every deque is empty, work is done.
+static int batch_next_job(struct batch_worker *worker, uint32_t *job)
+{
+	if (batch_pop(&worker->deque, job))
+		return 1;
+
+	for (uint32_t i = 1; i < worker_nb; i++) {
+		struct batch_worker *victim =
+			&workers[(worker->id + i) % worker_nb];
+		if (batch_steal(&victim->deque, job))
+			return 1;
+	}
+	return 0;
+}
+
+static void *batch_worker_main(void *arg)
+{
+	struct batch_worker *worker = arg;
+	struct gb *gb;
+	uint32_t job;
+
+	gb = gb_create();
+	if (!gb)
+		return NULL;
+	gpu_set_headless(gb, 1);
+	// sessions must not depend on each other through save files
+	mem_set_save_interval(gb, MEM_SAVE_NONE);
+
+	while (batch_next_job(worker, &job))
+		batch_run_job(gb, &jobs[job]);
+
+	gb_destroy(gb);
+	return NULL;
+}
+
+static int batch_load_manifest(char *path)
+{
+	char line[LINE_SIZE];
+	struct batch_job *tmp;
+	FILE *fd;
+
+	fd = fopen(path, "r");
+	if (!fd) {
+		printf("failed to open manifest '%s'\n", path);
+		return -EINVAL;
+	}
+
+	while (fgets(line, LINE_SIZE, fd)) {
+		// until a worker runs it
+		struct batch_job job = { .status = -ECANCELED };
+
+		if (line[0] == '#' || sscanf(line, "%1023s %1023s %u", job.rom,
+					     job.script, &job.frame_nb) != 3)
+			continue;
+
+		tmp = realloc(jobs, (job_nb + 1) * sizeof(*jobs));
+		if (!tmp) {
+			fclose(fd);
+			return -ENOMEM;
+		}
+		jobs = tmp;
+		jobs[job_nb++] = job;
+	}
+
+	fclose(fd);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t started;
+	int ret = 0;
+	int err;
+
+	if (argc < 2 || argc > 3) {
+		printf("Invalid command usage, shall be:\n");
+		printf("        ./balaboy-batch <manifest_path> <option: thread number>\n");
+		printf("Example:\n");
+		printf("        ./balaboy-batch nightly.txt 64\n");
+		return -EINVAL;
+	}
+
+	ret = batch_load_manifest(argv[1]);
+	if (ret < 0)
+		goto exit;
+
+	worker_nb = argc >= 3 ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_nb <= 0)
+		worker_nb = 1;
+	if (worker_nb > job_nb)
+		worker_nb = job_nb ? job_nb : 1;
+
+	workers = calloc(worker_nb, sizeof(*workers));
+	if (!workers) {
+		ret = -ENOMEM;
+		goto exit;
+	}
+
+	// deal the jobs round robin, stealing evens out the remaining imbalance
+	for (uint32_t i = 0; i < worker_nb; i++) {
+		struct batch_deque *deque = &workers[i].deque;
+
+		workers[i].id = i;
+		pthread_mutex_init(&deque->lock, NULL);
+		deque->jobs = calloc(job_nb / worker_nb + 1, sizeof(uint32_t));
+		if (!deque->jobs) {
+			ret = -ENOMEM;
+			goto exit;
+		}
+		for (uint32_t j = i; j < job_nb; j += worker_nb)
+			deque->jobs[deque->tail++] = j;
+	}
+
+	// the jobs of a worker which could not start are stolen by the others
+	for (started = 0; started < worker_nb; started++) {
+		err = pthread_create(&workers[started].thread, NULL,
+				     batch_worker_main, &workers[started]);
+		if (err) {
+			printf("failed to start worker %u (%d)\n", started, err);
+			ret = -err;
+			break;
+		}
+	}
+	for (uint32_t i = 0; i < started; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	for (uint32_t i = 0; i < job_nb; i++) {
+		if (jobs[i].status < 0) {
+			printf("%s %s FAILED (%d)\n", jobs[i].rom, jobs[i].script,
+			       jobs[i].status);
+			ret = -EINVAL;
+			continue;
+		}
+		printf("%s %s frames=%u ram=%016" PRIx64 " fb=%016" PRIx64
+		       " fps=%.1f\n",
+		       jobs[i].rom, jobs[i].script, jobs[i].frame_nb,
+		       jobs[i].ram_hash, jobs[i].fb_hash, jobs[i].fps);
+	}
+
+exit:
+	if (workers) {
+		for (uint32_t i = 0; i < worker_nb; i++) {
+			pthread_mutex_destroy(&workers[i].deque.lock);
+			free(workers[i].deque.jobs);
+		}
+		free(workers);
+	}
+	free(jobs);
+	return ret;
+}
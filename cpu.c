@@ -1,60 +1,172 @@
+#include <stddef.h>
 #include <stdlib.h>
 
-#include "cpu.h"
-#include "memory.h"
+#include "cpu_opcodes.h"
+#include "gb.h"
 
 /////////////////////////////////////////////////////////////////////////////////////
 // defintions and local stuff
 /////////////////////////////////////////////////////////////////////////////////////
 
-// define locally the CPU register structure
-struct cpu_registers {
-	uint8_t A;
-	uint8_t F;
-	uint8_t B;
-	uint8_t C;
-	uint8_t D;
-	uint8_t E;
-	uint8_t H;
-	uint8_t L;
-	uint16_t SP; // stack pointer
-	uint16_t PC; // program counter
+// Flags are not computed by the ALU helpers: they record the operation and
+// its operands in gb->cpu.flags, and the flags are only computed when
+// somebody reads them.
+// Define CPU_NO_LAZY_FLAGS to compute them right after each operation.
+typedef enum {
+	LAZY_NONE,
+	LAZY_ADD, // ADD, ADC
+	LAZY_SUB, // SUB, SBC, CP
+	LAZY_AND,
+	LAZY_OR, // OR, XOR
+	LAZY_INC,
+	LAZY_DEC,
+	LAZY_ADD16, // ADD HL,rr
+	LAZY_SHIFT, // rotates, shifts, SWAP: carry is the bit shifted out
+	LAZY_BIT,
+} cpu_lazy_op;
+
+// bits of F written by each cpu_lazy_op
+static const uint8_t lazy_flags_mask[] = {
+	[LAZY_NONE] = 0x00,  [LAZY_ADD] = 0xF0, [LAZY_SUB] = 0xF0,
+	[LAZY_AND] = 0xF0,   [LAZY_OR] = 0xF0,  [LAZY_INC] = 0xE0,
+	[LAZY_DEC] = 0xE0,   [LAZY_ADD16] = 0x70, [LAZY_SHIFT] = 0xF0,
+	[LAZY_BIT] = 0xE0,
 };
 
-// declare locally an instance of the register structure.
-// This struct var has to be reach externally via getter and setter funcions
-static struct cpu_registers regs;
-
-static uint8_t	cpu_interrupts_enabled = 1;
-
-static uint8_t cpu_exec_opcode_CB(uint8_t opcode);
+struct cpu_op;
+static void cpu_exec_opcode_CB(struct gb *gb, struct cpu_op *op,
+			       uint8_t opcode);
 
 /////////////////////////////////////////////////////////////////////////////////////
 // private functions
 /////////////////////////////////////////////////////////////////////////////////////
 
-static void INC_u8(uint8_t *ptr)
+// compute Z/N/H/C of the last lazy operation, in their F register position
+static uint8_t lazy_flags_eval(struct gb *gb)
+{
+	uint8_t z = gb->cpu.flags.res == 0 ? 0x80 : 0x00;
+
+	switch (gb->cpu.flags.op) {
+	case LAZY_ADD:
+		return z |
+		       ((gb->cpu.flags.a & 0x0F) + (gb->cpu.flags.b & 0x0F) + gb->cpu.flags.carry > 0x0F ?
+				0x20 : 0x00) |
+		       (gb->cpu.flags.a + gb->cpu.flags.b + gb->cpu.flags.carry > 0xFF ? 0x10 : 0x00);
+	case LAZY_SUB:
+		return z | 0x40 |
+		       ((gb->cpu.flags.a & 0x0F) < (gb->cpu.flags.b & 0x0F) + gb->cpu.flags.carry ? 0x20 :
+									  0x00) |
+		       (gb->cpu.flags.a < gb->cpu.flags.b + gb->cpu.flags.carry ? 0x10 : 0x00);
+	case LAZY_AND:
+		return z | 0x20;
+	case LAZY_OR:
+		return z;
+	case LAZY_INC:
+		return z | (gb->cpu.flags.res == 0x00 ? 0x20 : 0x00);
+	case LAZY_DEC:
+		return z | 0x40 | (gb->cpu.flags.res == 0xFF ? 0x20 : 0x00);
+	case LAZY_ADD16:
+		return ((gb->cpu.flags.a & 0x00FF) + (gb->cpu.flags.b & 0x00FF) > 0xFF ? 0x20 :
+								       0x00) |
+		       ((uint32_t)gb->cpu.flags.a + (uint32_t)gb->cpu.flags.b > 0xFFFF ? 0x10 :
+								      0x00);
+	case LAZY_SHIFT:
+		return z | (gb->cpu.flags.carry ? 0x10 : 0x00);
+	case LAZY_BIT:
+		return z | 0x20;
+	default:
+		return 0x00;
+	}
+}
+
+// write the pending flags into F
+static void lazy_flags_sync(struct gb *gb)
+{
+	if (!gb->cpu.flags.mask)
+		return;
+	gb->cpu.regs.F = (gb->cpu.regs.F & ~gb->cpu.flags.mask) |
+			 (lazy_flags_eval(gb) & gb->cpu.flags.mask);
+	gb->cpu.flags.mask = 0;
+}
+
+static void lazy_flags_set(struct gb *gb, cpu_lazy_op op, uint16_t a,
+			   uint16_t b, uint8_t carry, uint8_t res)
+{
+	// flags of the previous operation which are not overwritten by this
+	// one have to be computed while its operands are still known
+	if (gb->cpu.flags.mask & ~lazy_flags_mask[op])
+		lazy_flags_sync(gb);
+
+	gb->cpu.flags.mask = lazy_flags_mask[op];
+	gb->cpu.flags.op = op;
+	gb->cpu.flags.a = a;
+	gb->cpu.flags.b = b;
+	gb->cpu.flags.carry = carry;
+	gb->cpu.flags.res = res;
+
+#ifdef CPU_NO_LAZY_FLAGS
+	lazy_flags_sync(gb);
+#endif
+}
+
+// Memory accesses of the instructions. Define CPU_ACCESS_TIMING for each of
+// them to happen one M-cycle after the previous one, so that the peripherals
+// computing their state from the time of the access see it in the middle of
+// the instruction. Otherwise the whole instruction happens at its first
+// cycle and its duration is only charged once it is over.
+#ifdef CPU_ACCESS_TIMING
+static uint8_t cpu_read(struct gb *gb, uint16_t addr)
+{
+	uint8_t value = mem_get_byte(gb, addr);
+
+	gb->cpu.cycles_access += 4;
+	return value;
+}
+
+static void cpu_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	mem_set_byte(gb, addr, value);
+	gb->cpu.cycles_access += 4;
+}
+
+static uint8_t cpu_read_high(struct gb *gb, uint8_t offset)
+{
+	uint8_t value = mem_get_high(gb, offset);
+
+	gb->cpu.cycles_access += 4;
+	return value;
+}
+
+static void cpu_write_high(struct gb *gb, uint8_t offset, uint8_t value)
+{
+	mem_set_high(gb, offset, value);
+	gb->cpu.cycles_access += 4;
+}
+#else
+#define cpu_read(gb, addr) mem_get_byte(gb, addr)
+#define cpu_write(gb, addr, value) mem_set_byte(gb, addr, value)
+#define cpu_read_high(gb, offset) mem_get_high(gb, offset)
+#define cpu_write_high(gb, offset, value) mem_set_high(gb, offset, value)
+#endif
+
+static void INC_u8(struct gb *gb, uint8_t *ptr)
 {
 	(*ptr)++;
-	cpu_set_flag(FLAG_ZERO, *ptr == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, *ptr == 0 ? TRUE : FALSE);
+	lazy_flags_set(gb, LAZY_INC, 0, 0, 0, *ptr);
 }
 
-static void DEC_u8(uint8_t *ptr)
+static void DEC_u8(struct gb *gb, uint8_t *ptr)
 {
 	(*ptr)--;
-	cpu_set_flag(FLAG_ZERO, *ptr == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, TRUE);
-	cpu_set_flag(FLAG_HALF_CARRY, *ptr == 255 ? TRUE : FALSE);
+	lazy_flags_set(gb, LAZY_DEC, 0, 0, 0, *ptr);
 	// TODO: check HC flag
 }
 
-static void LD_mem_u8(uint16_t addr, uint8_t src)
+static void LD_mem_u8(struct gb *gb, uint16_t addr, uint8_t src)
 {
 	/*if(addr == 0x9bff)
 		printf("test\n");*/
-	mem_set_byte(addr, src);
+	cpu_write(gb, addr, src);
 }
 
 static void LD_reg_u8(uint8_t *reg_u8, uint8_t src)
@@ -62,208 +174,146 @@ static void LD_reg_u8(uint8_t *reg_u8, uint8_t src)
 	*reg_u8 = src;
 }
 
-static void LD_mem_u16(uint16_t addr, uint16_t src)
+static void LD_mem_u16(struct gb *gb, uint16_t addr, uint16_t src)
 {
-	mem_set_byte(addr, src & 0x00FF);
-	mem_set_byte(addr + 1, src >> 8);
+	cpu_write(gb, addr, src & 0x00FF);
+	cpu_write(gb, addr + 1, src >> 8);
 }
 
-static void ADD_to_A(uint8_t val_to_add)
+static void ADD_to_A(struct gb *gb, uint8_t val_to_add)
 {
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY,
-		     (regs.A & 0x0F) + (val_to_add & 0x0F) > 0x0F ? TRUE :
-								    FALSE);
-	cpu_set_flag(FLAG_CARRY,
-		     (uint16_t)regs.A + (uint16_t)val_to_add > 0x00FF ? TRUE :
-									FALSE);
-	regs.A += val_to_add;
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	uint8_t res = gb->cpu.regs.A + val_to_add;
+	lazy_flags_set(gb, LAZY_ADD, gb->cpu.regs.A, val_to_add, 0, res);
+	gb->cpu.regs.A = res;
 	// TODO: check HC flag
 }
 
-static void ADC_to_A(uint8_t val_to_add)
-{
-	cpu_set_flag(FLAG_SUB, FALSE);
-	uint8_t tmp_hc = (regs.A & 0x0F) + (val_to_add & 0x0F) +
-						 cpu_get_flag(FLAG_CARRY) >
-					 0x0F ?
-				 TRUE :
-				 FALSE;
-	uint8_t tmp_h =
-		(uint16_t)regs.A + (uint16_t)val_to_add +
-					(uint16_t)cpu_get_flag(FLAG_CARRY) >
-				0x00FF ?
-			TRUE :
-			FALSE;
-	regs.A = regs.A + val_to_add + cpu_get_flag(FLAG_CARRY);
-	cpu_set_flag(FLAG_HALF_CARRY, tmp_hc);
-	cpu_set_flag(FLAG_CARRY, tmp_h);
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+static void ADC_to_A(struct gb *gb, uint8_t val_to_add)
+{
+	uint8_t carry = cpu_get_flag(gb, FLAG_CARRY);
+	uint8_t res = gb->cpu.regs.A + val_to_add + carry;
+	lazy_flags_set(gb, LAZY_ADD, gb->cpu.regs.A, val_to_add, carry, res);
+	gb->cpu.regs.A = res;
 	// TODO: check HC flag
 }
 
-static void SUB_to_A(uint8_t val_to_sub)
+static void SUB_to_A(struct gb *gb, uint8_t val_to_sub)
+{
+	uint8_t res = gb->cpu.regs.A - val_to_sub;
+	lazy_flags_set(gb, LAZY_SUB, gb->cpu.regs.A, val_to_sub, 0, res);
+	gb->cpu.regs.A = res;
+}
+
+static void SBC_to_A(struct gb *gb, uint8_t val_to_sub)
 {
-	cpu_set_flag(FLAG_SUB, TRUE);
-	cpu_set_flag(FLAG_HALF_CARRY,
-		     (regs.A & 0x0F) < (val_to_sub & 0x0F) ? TRUE : FALSE);
-	cpu_set_flag(FLAG_CARRY, regs.A < val_to_sub ? TRUE : FALSE);
-	//printf("[SUB] 0x%x - 0x%x = (uint8_t)  0x%x\n", regs.A, val_to_sub, (uint8_t)(regs.A - val_to_sub));
-	regs.A -= val_to_sub;
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	uint8_t carry = cpu_get_flag(gb, FLAG_CARRY);
+	uint8_t res = gb->cpu.regs.A - val_to_sub - carry;
+	lazy_flags_set(gb, LAZY_SUB, gb->cpu.regs.A, val_to_sub, carry, res);
+	gb->cpu.regs.A = res;
 }
 
-static void SBC_to_A(uint8_t val_to_sub)
+static void AND_with_A(struct gb *gb, uint8_t val)
 {
-	cpu_set_flag(FLAG_SUB, TRUE);
-	uint8_t tmp_hc = (regs.A & 0x0F) < ((val_to_sub & 0x0F) +
-					    cpu_get_flag(FLAG_CARRY)) ?
-				 TRUE :
-				 FALSE;
-	uint8_t tmp_h =
-		regs.A < (val_to_sub + cpu_get_flag(FLAG_CARRY)) ? TRUE : FALSE;
-	//printf("[SUB] 0x%x - 0x%x - 0x%x = (uint8_t)  0x%x\n", regs.A, val_to_sub, cpu_get_flag(FLAG_CARRY), (uint8_t)(regs.A - val_to_sub));
-	regs.A = regs.A - val_to_sub - cpu_get_flag(FLAG_CARRY);
-	cpu_set_flag(FLAG_HALF_CARRY, tmp_hc);
-	cpu_set_flag(FLAG_CARRY, tmp_h);
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	gb->cpu.regs.A &= val;
+	lazy_flags_set(gb, LAZY_AND, 0, 0, 0, gb->cpu.regs.A);
 }
 
-static void AND_with_A(uint8_t val)
+static void XOR_with_A(struct gb *gb, uint8_t val)
 {
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, TRUE);
-	cpu_set_flag(FLAG_CARRY, FALSE);
-	regs.A &= val;
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	gb->cpu.regs.A = gb->cpu.regs.A ^ val;
+	lazy_flags_set(gb, LAZY_OR, 0, 0, 0, gb->cpu.regs.A);
 }
 
-static void XOR_with_A(uint8_t val)
+static void OR_with_A(struct gb *gb, uint8_t val)
 {
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, FALSE);
-	//regs.A ^= val;
-	//printf(" A(0x%x) XOR val(0x%x) = 0x%x\n", regs.A, val, regs.A ^ val);
-	regs.A = regs.A ^ val;
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	gb->cpu.regs.A |= val;
+	lazy_flags_set(gb, LAZY_OR, 0, 0, 0, gb->cpu.regs.A);
 }
 
-static void OR_with_A(uint8_t val)
+static void CP_with_A(struct gb *gb, uint8_t val)
 {
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, FALSE);
-	regs.A |= val;
-	cpu_set_flag(FLAG_ZERO, regs.A == 0 ? TRUE : FALSE);
+	lazy_flags_set(gb, LAZY_SUB, gb->cpu.regs.A, val, 0, gb->cpu.regs.A - val);
 }
 
-static void CP_with_A(uint8_t val)
+static void ADD_to_HL(struct gb *gb, uint16_t val_to_add)
 {
-	cpu_set_flag(FLAG_SUB, TRUE);
-	cpu_set_flag(FLAG_HALF_CARRY, (regs.A & 0x0F) < (val & 0x0F) ? TRUE : FALSE);
-	cpu_set_flag(FLAG_CARRY, regs.A < val ? TRUE : FALSE);
-	cpu_set_flag(FLAG_ZERO, regs.A == val ? TRUE : FALSE);
+	// TODO: check if HC flag is managed correctly
+	lazy_flags_set(gb, LAZY_ADD16, cpu_get_HL(gb), val_to_add, 0, 0);
+	cpu_set_HL(gb, cpu_get_HL(gb) + val_to_add);
 }
 
-static uint16_t SP_pop(){
-	uint16_t tmp_u16 = mem_get_byte(regs.SP + 1) << 8 |
-	       			   mem_get_byte(regs.SP);
-	cpu_set_SP(cpu_get_SP()+2);
+static uint16_t SP_pop(struct gb *gb){
+	uint16_t tmp_u16 = cpu_read(gb, gb->cpu.regs.SP + 1) << 8 |
+	       			   cpu_read(gb, gb->cpu.regs.SP);
+	cpu_set_SP(gb, cpu_get_SP(gb)+2);
 	return tmp_u16;
 }
 
-/*static*/ void SP_push(uint16_t val){
-	cpu_set_SP(cpu_get_SP()-2);
-	LD_mem_u16(cpu_get_SP(), val);
+/*static*/ void SP_push(struct gb *gb, uint16_t val){
+	cpu_set_SP(gb, cpu_get_SP(gb)-2);
+	LD_mem_u16(gb, cpu_get_SP(gb), val);
 }
 
-static void RLC(uint8_t *dst){
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, *dst >> 7);
-	*dst = *dst << 1 | *dst >> 7;
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
+static void RLC(struct gb *gb, uint8_t *dst){
+	uint8_t carry = *dst >> 7;
+	*dst = *dst << 1 | carry;
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, carry, *dst);
 }
 
-static void RRC(uint8_t *dst){
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, *dst & 0x01);
-	*dst = *dst >> 1 | *dst << 7;
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
+static void RRC(struct gb *gb, uint8_t *dst){
+	uint8_t carry = *dst & 0x01;
+	*dst = *dst >> 1 | carry << 7;
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, carry, *dst);
 }
 
-static void RL(uint8_t *dst){
+static void RL(struct gb *gb, uint8_t *dst){
 	uint8_t tmp_carry = *dst >> 7;
-	*dst = (*dst << 1) | cpu_get_flag(FLAG_CARRY);
-	cpu_set_flag(FLAG_CARRY, tmp_carry);
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
+	*dst = (*dst << 1) | cpu_get_flag(gb, FLAG_CARRY);
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, tmp_carry, *dst);
 }
 
-static void RR(uint8_t *dst){
+static void RR(struct gb *gb, uint8_t *dst){
 	uint8_t tmp_carry = *dst & 0x01;
-	*dst = *dst >> 1 | cpu_get_flag(FLAG_CARRY) << 7;
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, tmp_carry);
+	*dst = *dst >> 1 | cpu_get_flag(gb, FLAG_CARRY) << 7;
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, tmp_carry, *dst);
 }
 
-static void SLA(uint8_t *dst){
+static void SLA(struct gb *gb, uint8_t *dst){
 	uint8_t tmp_carry = *dst >> 7;
 	*dst = (*dst << 1);
-	cpu_set_flag(FLAG_CARRY, tmp_carry);
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, tmp_carry, *dst);
 }
 
-static void SRA(uint8_t *dst){
+static void SRA(struct gb *gb, uint8_t *dst){
 	uint8_t tmp_carry = *dst & 0x01;
 	*dst = (*dst >> 1) | (*dst & 0x80);
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, tmp_carry);
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, tmp_carry, *dst);
 }
 
-static void SRL(uint8_t *dst){
+static void SRL(struct gb *gb, uint8_t *dst){
 	uint8_t tmp_carry = *dst & 0x01;
 	*dst = (*dst >> 1);
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, tmp_carry);
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, tmp_carry, *dst);
 }
 
-static void SWAP(uint8_t *dst){
+static void SWAP(struct gb *gb, uint8_t *dst){
 	uint8_t p1 = (*dst & 0x0F) << 4;
 	uint8_t p2 = *dst >> 4;
 	*dst = p1 | p2;
-	cpu_set_flag(FLAG_ZERO, *dst == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-	cpu_set_flag(FLAG_CARRY, FALSE);
+	lazy_flags_set(gb, LAZY_SHIFT, 0, 0, 0, *dst);
 }
 
 
-static void BIT(uint8_t bit2test, uint8_t *p_reg) {
+static void BIT(struct gb *gb, uint8_t bit2test, uint8_t *p_reg) {
 	uint8_t val = *p_reg & (1 << bit2test);
-	//printf("[BIT] %d = 0x%x & (1 << %d) = 0x%x & 0x%x\n", val, *p_reg, bit2test, *p_reg, (1 << bit2test));
-	cpu_set_flag(FLAG_ZERO, val == 0 ? TRUE : FALSE);
-	cpu_set_flag(FLAG_SUB, FALSE);
-	cpu_set_flag(FLAG_HALF_CARRY, TRUE);
+	lazy_flags_set(gb, LAZY_BIT, 0, 0, 0, val);
 }
 
-static void RES(uint8_t bit2test, uint8_t *p_reg) {
+static void RES(struct gb *gb, uint8_t bit2test, uint8_t *p_reg) {
 	*p_reg = *p_reg & ~(1 << bit2test);
 }
 
-static void SET(uint8_t bit2test, uint8_t *p_reg) {
+static void SET(struct gb *gb, uint8_t bit2test, uint8_t *p_reg) {
 	*p_reg = *p_reg | (1 << bit2test);
 }
 
@@ -271,2346 +321,2542 @@ static void SET(uint8_t bit2test, uint8_t *p_reg) {
 // public functions
 /////////////////////////////////////////////////////////////////////////////////////
 
-uint8_t cpu_get_interrupts_enabled()
+uint8_t cpu_get_interrupts_enabled(struct gb *gb)
+{
+	return gb->cpu.interrupts_enabled;
+}
+
+void cpu_set_interrupts_enabled(struct gb *gb, uint8_t val)
+{
+	gb->cpu.interrupts_enabled = val;
+}
+
+cpu_state cpu_get_state(struct gb *gb)
 {
-	return cpu_interrupts_enabled;
+	return gb->cpu.run_state;
 }
 
-void cpu_set_interrupts_enabled(uint8_t val)
+void cpu_set_state(struct gb *gb, cpu_state state)
 {
-	cpu_interrupts_enabled = val;
+	gb->cpu.run_state = state;
 }
 
-void cpu_reset_registers()
+void cpu_reset_registers(struct gb *gb)
 {
-	memset(&regs, 0, sizeof(struct cpu_registers));
+	memset(&gb->cpu.regs, 0, sizeof(struct cpu_registers));
+	memset(&gb->cpu.flags, 0, sizeof(struct cpu_lazy_flags));
 }
 
 // getter of 8 bits registers
-uint8_t cpu_get_A()
+uint8_t cpu_get_A(struct gb *gb)
 {
-	return regs.A;
+	return gb->cpu.regs.A;
 }
-uint8_t cpu_get_B()
+uint8_t cpu_get_B(struct gb *gb)
 {
-	return regs.B;
+	return gb->cpu.regs.B;
 }
-uint8_t cpu_get_C()
+uint8_t cpu_get_C(struct gb *gb)
 {
-	return regs.C;
+	return gb->cpu.regs.C;
 }
-uint8_t cpu_get_D()
+uint8_t cpu_get_D(struct gb *gb)
 {
-	return regs.D;
+	return gb->cpu.regs.D;
 }
-uint8_t cpu_get_E()
+uint8_t cpu_get_E(struct gb *gb)
 {
-	return regs.E;
+	return gb->cpu.regs.E;
 }
-uint8_t cpu_get_F()
+uint8_t cpu_get_F(struct gb *gb)
 {
-	return regs.F;
+	lazy_flags_sync(gb);
+	return gb->cpu.regs.F;
 }
-uint8_t cpu_get_H()
+uint8_t cpu_get_H(struct gb *gb)
 {
-	return regs.H;
+	return gb->cpu.regs.H;
 }
-uint8_t cpu_get_L()
+uint8_t cpu_get_L(struct gb *gb)
 {
-	return regs.L;
+	return gb->cpu.regs.L;
 }
 
 // setter of 8 bits registers
-void cpu_set_A(uint8_t value)
+void cpu_set_A(struct gb *gb, uint8_t value)
 {
-	regs.A = value;
+	gb->cpu.regs.A = value;
 }
-void cpu_set_B(uint8_t value)
+void cpu_set_B(struct gb *gb, uint8_t value)
 {
-	regs.B = value;
+	gb->cpu.regs.B = value;
 }
-void cpu_set_C(uint8_t value)
+void cpu_set_C(struct gb *gb, uint8_t value)
 {
-	regs.C = value;
+	gb->cpu.regs.C = value;
 }
-void cpu_set_D(uint8_t value)
+void cpu_set_D(struct gb *gb, uint8_t value)
 {
-	regs.D = value;
+	gb->cpu.regs.D = value;
 }
-void cpu_set_E(uint8_t value)
+void cpu_set_E(struct gb *gb, uint8_t value)
 {
-	regs.E = value;
+	gb->cpu.regs.E = value;
 }
-void cpu_set_F(uint8_t value)
+void cpu_set_F(struct gb *gb, uint8_t value)
 {
-	regs.F = value;
+	gb->cpu.flags.mask = 0;
+	gb->cpu.regs.F = value;
 }
-void cpu_set_H(uint8_t value)
+void cpu_set_H(struct gb *gb, uint8_t value)
 {
-	regs.H = value;
+	gb->cpu.regs.H = value;
 }
-void cpu_set_L(uint8_t value)
+void cpu_set_L(struct gb *gb, uint8_t value)
 {
-	regs.L = value;
+	gb->cpu.regs.L = value;
 }
 
 // getter of 16 bits registers
-uint16_t cpu_get_AF()
+uint16_t cpu_get_AF(struct gb *gb)
 {
-	return regs.A << 8 | regs.F;
+	lazy_flags_sync(gb);
+	return gb->cpu.regs.A << 8 | gb->cpu.regs.F;
 }
-uint16_t cpu_get_BC()
+uint16_t cpu_get_BC(struct gb *gb)
 {
-	return regs.B << 8 | regs.C;
+	return gb->cpu.regs.B << 8 | gb->cpu.regs.C;
 }
-uint16_t cpu_get_DE()
+uint16_t cpu_get_DE(struct gb *gb)
 {
-	return regs.D << 8 | regs.E;
+	return gb->cpu.regs.D << 8 | gb->cpu.regs.E;
 }
-uint16_t cpu_get_HL()
+uint16_t cpu_get_HL(struct gb *gb)
 {
-	return regs.H << 8 | regs.L;
+	return gb->cpu.regs.H << 8 | gb->cpu.regs.L;
 }
 
 // getter of 16 bits registers
-void cpu_set_AF(uint16_t value)
+void cpu_set_AF(struct gb *gb, uint16_t value)
 {
-	regs.A = (uint8_t)(value >> 8);
-	regs.F = (uint8_t)(value & 0x00FF);
+	gb->cpu.regs.A = (uint8_t)(value >> 8);
+	gb->cpu.flags.mask = 0;
+	gb->cpu.regs.F = (uint8_t)(value & 0x00FF);
 }
-void cpu_set_BC(uint16_t value)
+void cpu_set_BC(struct gb *gb, uint16_t value)
 {
-	regs.B = (uint8_t)(value >> 8);
-	regs.C = (uint8_t)(value & 0x00FF);
+	gb->cpu.regs.B = (uint8_t)(value >> 8);
+	gb->cpu.regs.C = (uint8_t)(value & 0x00FF);
 }
-void cpu_set_DE(uint16_t value)
+void cpu_set_DE(struct gb *gb, uint16_t value)
 {
-	regs.D = (uint8_t)(value >> 8);
-	regs.E = (uint8_t)(value & 0x00FF);
+	gb->cpu.regs.D = (uint8_t)(value >> 8);
+	gb->cpu.regs.E = (uint8_t)(value & 0x00FF);
 }
-void cpu_set_HL(uint16_t value)
+void cpu_set_HL(struct gb *gb, uint16_t value)
 {
-	regs.H = (uint8_t)(value >> 8);
-	regs.L = (uint8_t)(value & 0x00FF);
+	gb->cpu.regs.H = (uint8_t)(value >> 8);
+	gb->cpu.regs.L = (uint8_t)(value & 0x00FF);
 }
 
 // getter of 16 bits registers
-uint16_t cpu_get_SP()
+uint16_t cpu_get_SP(struct gb *gb)
 {
-	return regs.SP;
+	return gb->cpu.regs.SP;
 }
-uint16_t cpu_get_PC()
+uint16_t cpu_get_PC(struct gb *gb)
 {
-	return regs.PC;
+	return gb->cpu.regs.PC;
 }
 
 // setter of 16 bits registers
-void cpu_set_SP(uint16_t value)
+void cpu_set_SP(struct gb *gb, uint16_t value)
 {
-	regs.SP = value;
+	gb->cpu.regs.SP = value;
 }
-void cpu_set_PC(uint16_t value)
+void cpu_set_PC(struct gb *gb, uint16_t value)
 {
-	regs.PC = value;
+	gb->cpu.regs.PC = value;
 }
 
-int cpu_set_flag(cpu_flag_name flag, cpu_flag_value value)
+int cpu_set_flag(struct gb *gb, cpu_flag_name flag, cpu_flag_value value)
 {
-	switch (flag) {
-	case FLAG_ZERO:
-		regs.F = regs.F & 0x7F | value << 7;
-		break;
-	case FLAG_SUB:
-		regs.F = regs.F & 0xBF | value << 6;
-		break;
-	case FLAG_HALF_CARRY:
-		regs.F = regs.F & 0xDF | value << 5;
-		break;
-	case FLAG_CARRY:
-		regs.F = regs.F & 0xEF | value << 4;
-		break;
-	default:
+	uint8_t bit;
+
+	if (flag > FLAG_CARRY) {
 		printf("[ERROR][%s:%d] invalid flag\n", __func__, __LINE__);
+		return 0;
 	}
 
+	// Z is bit 7 of F, N bit 6, H bit 5 and C bit 4
+	bit = 0x80 >> flag;
+	gb->cpu.flags.mask &= ~bit;
+	gb->cpu.regs.F = (gb->cpu.regs.F & ~bit) | value << (7 - flag);
+
 	return 0;
 }
 
-cpu_flag_value cpu_get_flag(cpu_flag_name flag)
-{
-	cpu_flag_value ret = FALSE;
-	switch (flag) {
-	case FLAG_ZERO:
-		ret = regs.F & 0x80 ? TRUE : FALSE;
-		break;
-	case FLAG_SUB:
-		ret = regs.F & 0x40 ? TRUE : FALSE;
-		break;
-	case FLAG_HALF_CARRY:
-		ret = regs.F & 0x20 ? TRUE : FALSE;
-		break;
-	case FLAG_CARRY:
-		ret = regs.F & 0x10 ? TRUE : FALSE;
-		break;
-	default:
+cpu_flag_value cpu_get_flag(struct gb *gb, cpu_flag_name flag)
+{
+	uint8_t bit;
+
+	if (flag > FLAG_CARRY) {
 		printf("[ERROR][%s:%d] invalid flag\n", __func__, __LINE__);
+		return FALSE;
 	}
+
+	bit = 0x80 >> flag;
+	if (gb->cpu.flags.mask & bit)
+		return lazy_flags_eval(gb) & bit ? TRUE : FALSE;
+
+	return gb->cpu.regs.F & bit ? TRUE : FALSE;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// opcode handlers
+/////////////////////////////////////////////////////////////////////////////////////
+
+// instruction being executed, filled by the dispatcher before calling the handler
+struct cpu_op {
+	uint8_t u8; // byte following the opcode
+	uint16_t u16; // u16 following the opcode: OP B1 B2 => B1 is LSB, B2 is MSB
+	uint8_t duration; // duration in clock cycles, raised by taken branches
+	uint8_t add_lg; // cleared by handlers which set PC themselves
+};
+
+static void op_ILLEGAL(struct gb *gb, struct cpu_op *op)
+{
+	printf("[ERROR][%s:%d] unkown opcode 0x%x!\n", __func__, __LINE__,
+	       mem_get_byte(gb, gb->cpu.regs.PC));
+	exit(0);
 }
 
-uint8_t cpu_exec_opcode(uint8_t *opcode_length, uint8_t *opcode_duration)
+// 0x00: NOP
+static void op_NOP(struct gb *gb, struct cpu_op *op)
 {
-	uint8_t length = 0; // length in byte
-	uint8_t duration = 0; // duration in clock cycles
-	uint8_t opcode = mem_get_byte(regs.PC);
-	uint8_t u8 = mem_get_byte(regs.PC + 1);
+}
 
-	// Get the u16 value after opcode even if not needed.
-	// Done before the switch per pure laziness (and to avoid possible error since we have 250+ case)
-
-	// TODO: WARNING: check u8 LSB is OK for all u16 used by opcodes
-	uint16_t u16 = mem_get_byte(regs.PC + 2) << 8 |
-		       u8; // OP B1 B2 => B1 is LSB, B2 is MSB
-
-	uint32_t u32 = 0;
-	int8_t r8;
-	uint8_t tmp_carry;
-	uint8_t add_lg = 1;
-
-	switch (opcode) {
-	// 0x0X ////////////////////////////////////////////////////////////////
-	case 0x00: // NOP
-		length = 1;
-		duration = 4;
-		break;
-
-	case 0x01: // LD BC,d16
-		length = 3;
-		duration = 12;
-		cpu_set_BC(u16);
-		break;
-
-	case 0x02: // LD (BC),A
-		length = 1;
-		duration = 8;
-		LD_mem_u8(cpu_get_BC(), regs.A);
-		break;
-
-	case 0x03: // INC BC
-		length = 1;
-		duration = 8;
-		cpu_set_BC(cpu_get_BC() + 1);
-		break;
-
-	case 0x04: // INC B
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.B);
-		break;
-
-	case 0x05: // DEC B
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.B);
-		break;
-
-	case 0x06: // LD B,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.B, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x07: // RLC A
-		length = 1;
-		duration = 4;
-		RLC(&regs.A);
-		break;
-
-	case 0x08: // LD (a16),SP
-		length = 3;
-		duration = 20;
-		LD_mem_u16(u16, regs.SP);
-		break;
-
-	case 0x09: // ADD HL,BC
-		length = 1;
-		duration = 8;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     regs.L + regs.C > 0xFF ? TRUE : FALSE);
-		cpu_set_flag(FLAG_CARRY,
-			     (uint32_t)cpu_get_HL() + (uint32_t)cpu_get_BC() >
-					     0xFFFF ?
-				     TRUE :
-				     FALSE);
-		cpu_set_HL(cpu_get_HL() + cpu_get_BC());
-		break;
-
-	case 0x0A: // LD A,(BC)
-		length = 1;
-		duration = 8;
-		LD_reg_u8(&regs.A, mem_get_byte(cpu_get_BC()));
-		break;
-
-	case 0x0B: // DEC BC
-		length = 1;
-		duration = 8;
-		cpu_set_BC(cpu_get_BC() - 1);
-		break;
-
-	case 0x0C: // INC C
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.C);
-		break;
-
-	case 0x0D: // DEC C
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.C);
-		break;
-
-	case 0x0E: // LD C,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.C, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x0F: // RRC A
-		length = 1;
-		duration = 4;
-		RRC(&regs.A);
-		break;
-
-	// 0x1X ////////////////////////////////////////////////////////////////
-	case 0x10: // STOP
-		length = 2;
-		duration = 8;
-		// TODO: perform stop action
-		break;
-
-	case 0x11: // LD DE,d16
-		length = 3;
-		duration = 12;
-		cpu_set_DE(u16);
-		break;
-
-	case 0x12: // LD (DE),A
-		length = 1;
-		duration = 8;
-		LD_mem_u8(cpu_get_DE(), regs.A);
-		break;
-
-	case 0x13: // INC DE
-		length = 1;
-		duration = 8;
-		cpu_set_DE(cpu_get_DE() + 1);
-		break;
-
-	case 0x14: // INC D
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.D);
-		break;
-
-	case 0x15: // DEC D
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.D);
-		break;
-
-	case 0x16: // LD D,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.D, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x17: // RL A
-		length = 1;
-		duration = 4;
-		RL(&regs.A);
-		break;
-
-	case 0x18: // JR r8
-		length = 2;
-		duration = 12;
-		int8_t i8 = (int8_t)mem_get_byte(regs.PC + 1);
-		/*printf("[cpu.c] regs.PC + i8 = 0x%x = 0x%x + %d (0x%x)\n",
-		       regs.PC + i8, regs.PC, i8, mem_get_byte(regs.PC + 1));
-		printf("[cpu.c] int16_t (int16_t)regs.PC + (int16_t)i8 = %d + %d = %d\n",
-		       (int16_t)regs.PC + (int16_t)i8, (int16_t)regs.PC,
-		       (int16_t)i8);*/
-		regs.PC = (uint16_t)(
-			(int16_t)regs.PC +
+// 0x01: LD BC,d16
+static void op_LD_BC_d16(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_BC(gb, op->u16);
+}
+
+// 0x02: LD (BC),A
+static void op_LD_mBC_A(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u8(gb, cpu_get_BC(gb), gb->cpu.regs.A);
+}
+
+// 0x03: INC BC
+static void op_INC_BC(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_BC(gb, cpu_get_BC(gb) + 1);
+}
+
+// 0x04: INC B
+static void op_INC_B(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.B);
+}
+
+// 0x05: DEC B
+static void op_DEC_B(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.B);
+}
+
+// 0x06: LD B,d8
+static void op_LD_B_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.B, op->u8);
+}
+
+// 0x07: RLC A
+static void op_RLC_A(struct gb *gb, struct cpu_op *op)
+{
+	RLC(gb, &gb->cpu.regs.A);
+}
+
+// 0x08: LD (a16),SP
+static void op_LD_ma16_SP(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u16(gb, op->u16, gb->cpu.regs.SP);
+}
+
+// 0x09: ADD HL,BC
+static void op_ADD_HL_BC(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_HL(gb, cpu_get_BC(gb));
+}
+
+// 0x0A: LD A,(BC)
+static void op_LD_A_mBC(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.A, cpu_read(gb, cpu_get_BC(gb)));
+}
+
+// 0x0B: DEC BC
+static void op_DEC_BC(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_BC(gb, cpu_get_BC(gb) - 1);
+}
+
+// 0x0C: INC C
+static void op_INC_C(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.C);
+}
+
+// 0x0D: DEC C
+static void op_DEC_C(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.C);
+}
+
+// 0x0E: LD C,d8
+static void op_LD_C_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.C, op->u8);
+}
+
+// 0x0F: RRC A
+static void op_RRC_A(struct gb *gb, struct cpu_op *op)
+{
+	RRC(gb, &gb->cpu.regs.A);
+}
+
+// 0x1X ////////////////////////////////////////////////////////////////
+
+// 0x10: STOP
+static void op_STOP(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.run_state = CPU_STOPPED;
+}
+
+// 0x11: LD DE,d16
+static void op_LD_DE_d16(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_DE(gb, op->u16);
+}
+
+// 0x12: LD (DE),A
+static void op_LD_mDE_A(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u8(gb, cpu_get_DE(gb), gb->cpu.regs.A);
+}
+
+// 0x13: INC DE
+static void op_INC_DE(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_DE(gb, cpu_get_DE(gb) + 1);
+}
+
+// 0x14: INC D
+static void op_INC_D(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.D);
+}
+
+// 0x15: DEC D
+static void op_DEC_D(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.D);
+}
+
+// 0x16: LD D,d8
+static void op_LD_D_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.D, op->u8);
+}
+
+// 0x17: RL A
+static void op_RL_A(struct gb *gb, struct cpu_op *op)
+{
+	RL(gb, &gb->cpu.regs.A);
+}
+
+// 0x18: JR r8
+static void op_JR_r8(struct gb *gb, struct cpu_op *op)
+{
+	int8_t i8 = (int8_t)op->u8;
+	gb->cpu.regs.PC = (uint16_t)(
+		(int16_t)gb->cpu.regs.PC +
+		(int16_t)i8); // TODO: check if final PC value is right
+}
+
+// 0x19: ADD HL,DE
+static void op_ADD_HL_DE(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_HL(gb, cpu_get_DE(gb));
+}
+
+// 0x1A: LD A,(DE)
+static void op_LD_A_mDE(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.A, cpu_read(gb, cpu_get_DE(gb)));
+}
+
+// 0x1B: DEC DE
+static void op_DEC_DE(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_DE(gb, cpu_get_DE(gb) - 1);
+}
+
+// 0x1C: INC E
+static void op_INC_E(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.E);
+}
+
+// 0x1D: DEC E
+static void op_DEC_E(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.E);
+}
+
+// 0x1E: LD E,d8
+static void op_LD_E_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.E, op->u8);
+}
+
+// 0x1F: RR A
+static void op_RR_A(struct gb *gb, struct cpu_op *op)
+{
+	RR(gb, &gb->cpu.regs.A);
+}
+
+// 0x2X ////////////////////////////////////////////////////////////////
+
+// 0x20: JR NZ,r8
+static void op_JR_NZ_r8(struct gb *gb, struct cpu_op *op)
+{
+	if (!cpu_get_flag(gb, FLAG_ZERO)) {
+		op->duration = 12;
+		int8_t i8 = (int8_t)op->u8;
+		gb->cpu.regs.PC = (uint16_t)(
+			(int16_t)gb->cpu.regs.PC +
 			(int16_t)i8); // TODO: check if final PC value is right
-		//printf("[cpu.c] regs.PC = 0x%x\n", regs.PC);
-		break;
-
-	case 0x19: // ADD HL,DE
-		length = 1;
-		duration = 8;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     regs.L + regs.E > 0xFF ? TRUE : FALSE);
-		cpu_set_flag(FLAG_CARRY,
-			     (uint32_t)cpu_get_HL() + (uint32_t)cpu_get_DE() >
-					     0xFFFF ?
-				     TRUE :
-				     FALSE);
-		cpu_set_HL(cpu_get_HL() + cpu_get_DE());
-		break;
-
-	case 0x1A: // LD A,(DE)
-		length = 1;
-		duration = 8;
-		LD_reg_u8(&regs.A, mem_get_byte(cpu_get_DE()));
-		break;
-
-	case 0x1B: // DEC DE
-		length = 1;
-		duration = 8;
-		cpu_set_DE(cpu_get_DE() - 1);
-		break;
-
-	case 0x1C: // INC E
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.E);
-		break;
-
-	case 0x1D: // DEC E
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.E);
-		break;
-
-	case 0x1E: // LD E,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.E, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x1F: // RR A
-		length = 1;
-		duration = 4;
-		RR(&regs.A);
-		break;
-
-	// 0x2X ////////////////////////////////////////////////////////////////
-	case 0x20: // JR NZ,r8
-		length = 2;
-
-		if (cpu_get_flag(FLAG_ZERO)) {
-			duration = 8;
-		} else {
-			duration = 12;
-			int8_t i8 = (int8_t)mem_get_byte(regs.PC + 1);
-			regs.PC = (uint16_t)(
-				(int16_t)regs.PC +
-				(int16_t)i8); // TODO: check if final PC value is right
-			regs.PC += 2;
-			add_lg = 0;
-		}
-		break;
-
-	case 0x21: // LD HL,d16
-		length = 3;
-		duration = 12;
-		cpu_set_HL(u16);
-		break;
-
-	case 0x22: // LD (HL+),A
-		length = 1;
-		duration = 8;
-		LD_mem_u8(cpu_get_HL(), regs.A);
-		cpu_set_HL(cpu_get_HL() + 1);
-		break;
-
-	case 0x23: // INC HL
-		length = 1;
-		duration = 8;
-		cpu_set_HL(cpu_get_HL() + 1);
-		break;
-
-	case 0x24: // INC H
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.H);
-		break;
-
-	case 0x25: // DEC H
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.H);
-		break;
-
-	case 0x26: // LD H,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.H, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x27: // DAA
-		length = 1;
-		duration = 4;
-		uint8_t D1 = regs.A >> 4;
-		uint8_t D2 = regs.A & 0x0F;
-		if (cpu_get_flag(FLAG_SUB)) {
-			if (cpu_get_flag(FLAG_SUB) | D2 > 9)
-				D2 -= 6;
-			if (cpu_get_flag(FLAG_CARRY))
-				D1 -= 6;
-			if (D1 > 9) {
-				D1 -= 6;
-				cpu_set_flag(FLAG_CARRY, TRUE);
-			}
-		} else {
-			if (cpu_get_flag(FLAG_HALF_CARRY))
-				D2 += 6;
-			if (cpu_get_flag(FLAG_CARRY))
-				D1 += 6;
-			if (D2 > 9) {
-				D2 -= 10;
-				D1++;
-			}
-			if (D1 > 9) {
-				D1 -= 10;
-				cpu_set_flag(FLAG_CARRY, TRUE);
-			}
-		}
-		regs.A = ((D1 << 4) & 0xF0) | (D2 & 0x0F);
-		cpu_set_flag(FLAG_ZERO, (regs.A == 0));
-		cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-		break;
-
-	case 0x28: // JR Z,r8
-		length = 2;
-
-		if (!cpu_get_flag(FLAG_ZERO)) {
-			duration = 8;
-		} else {
-			duration = 12;
-			int8_t i8 = (int8_t)mem_get_byte(regs.PC + 1);
-			regs.PC = (uint16_t)(
-				(int16_t)regs.PC +
-				(int16_t)i8); // TODO: check if final PC value is right
-			add_lg = 0;
-			regs.PC += 2;
-		}
-		break;
-
-	case 0x29: // ADD HL,HL // TODO
-		length = 1;
-		duration = 8;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		// TODO: check if HC flag is managed correctly
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     regs.L + regs.L > 0xFF ? TRUE : FALSE);
-		cpu_set_flag(FLAG_CARRY,
-			     (uint32_t)cpu_get_HL() + (uint32_t)cpu_get_HL() >
-					     0xFFFF ?
-				     TRUE :
-				     FALSE);
-		cpu_set_HL(cpu_get_HL() + cpu_get_HL());
-		break;
-
-	case 0x2A: // LD A,(HL+)
-		length = 1;
-		duration = 8;
-		LD_reg_u8(&regs.A, mem_get_byte(cpu_get_HL()));
-		cpu_set_HL(cpu_get_HL() + 1);
-		break;
-
-	case 0x2B: // DEC HL
-		length = 1;
-		duration = 8;
-		cpu_set_HL(cpu_get_HL() - 1);
-		break;
-
-	case 0x2C: // INC L
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.L);
-		break;
-
-	case 0x2D: // DEC L
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.L);
-		break;
-
-	case 0x2E: // LD L,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.L, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x2F: // CP L
-		length = 1;
-		duration = 4;
-		regs.A = ~regs.A;
-		cpu_set_flag(FLAG_SUB, TRUE);
-		cpu_set_flag(FLAG_HALF_CARRY, TRUE);
-		break;
-
-	// 0x3X ////////////////////////////////////////////////////////////////
-	case 0x30: // JR NC,r8
-		length = 2;
-
-		if (cpu_get_flag(FLAG_CARRY)) {
-			duration = 8;
-		} else {
-			duration = 12;
-			int8_t i8 = (int8_t)mem_get_byte(regs.PC + 1);
-			regs.PC = (uint16_t)(
-				(int16_t)regs.PC +
-				(int16_t)i8); // TODO: check if final PC value is right
-			add_lg = 0;
-			regs.PC += 2;
-		}
-		break;
-
-	case 0x31: // LD SP,d16
-		length = 3;
-		duration = 12;
-		cpu_set_SP(u16);
-		break;
-
-	case 0x32: // LD (HL-),A
-		length = 1;
-		duration = 8;
-		LD_mem_u8(cpu_get_HL(), regs.A);
-		cpu_set_HL(cpu_get_HL() - 1);
-		break;
-
-	case 0x33: // INC SP
-		length = 1;
-		duration = 8;
-		cpu_set_SP(cpu_get_SP() + 1);
-		break;
-
-	case 0x34: // INC (HL)
-		length = 1;
-		duration = 12;
-		mem_set_byte(cpu_get_HL(), mem_get_byte(cpu_get_HL()) + 1);
-		cpu_set_flag(FLAG_ZERO,
-			     mem_get_byte(cpu_get_HL()) == 0 ? TRUE : FALSE);
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     mem_get_byte(cpu_get_HL()) == 0 ? TRUE : FALSE);
-		break;
-
-	case 0x35: // DEC (HL)
-		length = 1;
-		duration = 12;
-		mem_set_byte(cpu_get_HL(), mem_get_byte(cpu_get_HL()) - 1);
-		cpu_set_flag(FLAG_ZERO,
-			     mem_get_byte(cpu_get_HL()) == 0 ? TRUE : FALSE);
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     mem_get_byte(cpu_get_HL()) == 255 ? TRUE : FALSE);
-		break;
-
-	case 0x36: // LD (HL),d8
-		length = 2;
-		duration = 12;
-		LD_mem_u8(cpu_get_HL(), u8);
-		break;
-
-	case 0x37: // SCF
-		length = 1;
-		duration = 4;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-		cpu_set_flag(FLAG_CARRY, TRUE);
-		break;
-
-	case 0x38: // JR C,r8
-		length = 2;
-
-		if (!cpu_get_flag(FLAG_CARRY)) {
-			duration = 8;
-		} else {
-			duration = 12;
-			int8_t i8 = (int8_t)mem_get_byte(regs.PC + 1);
-			regs.PC = (uint16_t)(
-				(int16_t)regs.PC +
-				(int16_t)i8); // TODO: check if final PC value is right
-			add_lg = 0;
-			regs.PC += 2;
-		}
-		break;
-
-	case 0x39: // ADD HL,SP //TODO
-		length = 1;
-		duration = 8;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		// TODO: check if HC flag is managed correctly
-		cpu_set_flag(FLAG_HALF_CARRY,
-			     regs.L + (regs.SP & 0x00FF) > 0xFF ? TRUE : FALSE);
-		cpu_set_flag(FLAG_CARRY,
-			     (uint32_t)cpu_get_HL() + (uint32_t)cpu_get_SP() >
-					     0xFFFF ?
-				     TRUE :
-				     FALSE);
-		cpu_set_HL(cpu_get_HL() + cpu_get_SP());
-		break;
-
-	case 0x3A: // LD A,(HL-)
-		length = 1;
-		duration = 8;
-		LD_reg_u8(&regs.A, mem_get_byte(cpu_get_HL()));
-		cpu_set_HL(cpu_get_HL() - 1);
-		break;
-
-	case 0x3B: // DEC SP
-		length = 1;
-		duration = 8;
-		cpu_set_SP(cpu_get_SP() - 1);
-		break;
-
-	case 0x3C: // INC A
-		length = 1;
-		duration = 4;
-		INC_u8(&regs.A);
-		break;
-
-	case 0x3D: // DEC A
-		length = 1;
-		duration = 4;
-		DEC_u8(&regs.A);
-		break;
-
-	case 0x3E: // LD A,d8
-		length = 2;
-		duration = 8;
-		LD_reg_u8(&regs.A, mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0x3F: // CCF
-		length = 1;
-		duration = 4;
-		cpu_set_flag(FLAG_SUB, FALSE);
-		cpu_set_flag(FLAG_HALF_CARRY, FALSE);
-		cpu_set_flag(FLAG_CARRY,
-			     cpu_get_flag(FLAG_CARRY) ? FALSE : TRUE);
-		break;
-
-	// 0x4X ////////////////////////////////////////////////////////////////
-	case 0x40: // LD B,B
-		length = 1;
-		duration = 4;
-		regs.B = regs.B;
-		break;
-
-	case 0x41: // LD B,C
-		length = 1;
-		duration = 4;
-		regs.B = regs.C;
-		break;
-
-	case 0x42: // LD B,D
-		length = 1;
-		duration = 4;
-		regs.B = regs.D;
-		break;
-
-	case 0x43: // LD B,E
-		length = 1;
-		duration = 4;
-		regs.B = regs.E;
-		break;
-
-	case 0x44: // LD B,H
-		length = 1;
-		duration = 4;
-		regs.B = regs.H;
-		break;
-
-	case 0x45: // LD B,L
-		length = 1;
-		duration = 4;
-		regs.B = regs.L;
-		break;
-
-	case 0x46: // LD B,(HL)
-		length = 1;
-		duration = 8;
-		regs.B = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x47: // LD B,A
-		length = 1;
-		duration = 4;
-		regs.B = regs.A;
-		break;
-
-	case 0x48: // LD C,B
-		length = 1;
-		duration = 4;
-		regs.C = regs.B;
-		break;
-
-	case 0x49: // LD C,C
-		length = 1;
-		duration = 4;
-		regs.C = regs.C;
-		break;
-
-	case 0x4A: // LD C,D
-		length = 1;
-		duration = 4;
-		regs.C = regs.D;
-		break;
-
-	case 0x4B: // LD C,E
-		length = 1;
-		duration = 4;
-		regs.C = regs.E;
-		break;
-
-	case 0x4C: // LD C,H
-		length = 1;
-		duration = 4;
-		regs.C = regs.H;
-		break;
-
-	case 0x4D: // LD C,L
-		length = 1;
-		duration = 4;
-		regs.C = regs.L;
-		break;
-
-	case 0x4E: // LD C,(HL)
-		length = 1;
-		duration = 8;
-		regs.C = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x4F: // LD C,A
-		length = 1;
-		duration = 4;
-		regs.C = regs.A;
-		break;
-
-	// 0x5X ////////////////////////////////////////////////////////////////
-	case 0x50: // LD D,B
-		length = 1;
-		duration = 4;
-		regs.D = regs.B;
-		break;
-
-	case 0x51: // LD D,C
-		length = 1;
-		duration = 4;
-		regs.D = regs.C;
-		break;
-
-	case 0x52: // LD BDD
-		length = 1;
-		duration = 4;
-		regs.D = regs.D;
-		break;
-
-	case 0x53: // LD D,E
-		length = 1;
-		duration = 4;
-		regs.D = regs.E;
-		break;
-
-	case 0x54: // LD D,H
-		length = 1;
-		duration = 4;
-		regs.D = regs.H;
-		break;
-
-	case 0x55: // LD D,L
-		length = 1;
-		duration = 4;
-		regs.D = regs.L;
-		break;
-
-	case 0x56: // LD D,(HL)
-		length = 1;
-		duration = 8;
-		regs.D = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x57: // LD D,A
-		length = 1;
-		duration = 4;
-		regs.D = regs.A;
-		break;
-
-	case 0x58: // LD E,B
-		length = 1;
-		duration = 4;
-		regs.E = regs.B;
-		break;
-
-	case 0x59: // LD E,C
-		length = 1;
-		duration = 4;
-		regs.E = regs.C;
-		break;
-
-	case 0x5A: // LD E,D
-		length = 1;
-		duration = 4;
-		regs.E = regs.D;
-		break;
-
-	case 0x5B: // LD E,E
-		length = 1;
-		duration = 4;
-		regs.E = regs.E;
-		break;
-
-	case 0x5C: // LD E,H
-		length = 1;
-		duration = 4;
-		regs.E = regs.H;
-		break;
-
-	case 0x5D: // LD E,L
-		length = 1;
-		duration = 4;
-		regs.E = regs.L;
-		break;
-
-	case 0x5E: // LD E,(HL)
-		length = 1;
-		duration = 8;
-		regs.E = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x5F: // LD E,A
-		length = 1;
-		duration = 4;
-		regs.E = regs.A;
-		break;
-
-	// 0x6X ////////////////////////////////////////////////////////////////
-	case 0x60: // LD H,B
-		length = 1;
-		duration = 4;
-		regs.H = regs.B;
-		break;
-
-	case 0x61: // LD H,C
-		length = 1;
-		duration = 4;
-		regs.H = regs.C;
-		break;
-
-	case 0x62: // LD H,D
-		length = 1;
-		duration = 4;
-		regs.H = regs.D;
-		break;
-
-	case 0x63: // LD H,E
-		length = 1;
-		duration = 4;
-		regs.H = regs.E;
-		break;
-
-	case 0x64: // LD H,H
-		length = 1;
-		duration = 4;
-		regs.H = regs.H;
-		break;
-
-	case 0x65: // LD H,L
-		length = 1;
-		duration = 4;
-		regs.H = regs.L;
-		break;
-
-	case 0x66: // LD D,(HL)
-		length = 1;
-		duration = 8;
-		regs.H = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x67: // LD H,A
-		length = 1;
-		duration = 4;
-		regs.H = regs.A;
-		break;
-
-	case 0x68: // LD L,B
-		length = 1;
-		duration = 4;
-		regs.L = regs.B;
-		break;
-
-	case 0x69: // LD L,C
-		length = 1;
-		duration = 4;
-		regs.L = regs.C;
-		break;
-
-	case 0x6A: // LD L,D
-		length = 1;
-		duration = 4;
-		regs.L = regs.D;
-		break;
-
-	case 0x6B: // LD L,E
-		length = 1;
-		duration = 4;
-		regs.L = regs.E;
-		break;
-
-	case 0x6C: // LD L,H
-		length = 1;
-		duration = 4;
-		regs.L = regs.H;
-		break;
-
-	case 0x6D: // LD L,L
-		length = 1;
-		duration = 4;
-		regs.L = regs.L;
-		break;
-
-	case 0x6E: // LD L,(HL)
-		length = 1;
-		duration = 8;
-		regs.L = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x6F: // LD L,A
-		length = 1;
-		duration = 4;
-		regs.L = regs.A;
-		break;
-
-	// 0x7X ////////////////////////////////////////////////////////////////
-	case 0x70: // LD (HL),B
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.B);
-		break;
-
-	case 0x71: // LD (HL),C
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.C);
-		break;
-
-	case 0x72: // LD (HL),D
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.D);
-		break;
-
-	case 0x73: // LD (HL),E
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.E);
-		break;
-
-	case 0x74: // LD (HL),H
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.H);
-		break;
-
-	case 0x75: // LD (HL),L
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.L);
-		break;
-
-	case 0x76: // HALT
-		length = 1;
-		duration = 4;
-		// TODO: HALT behavior ?
-		break;
-
-	case 0x77: // LD (HL),A
-		length = 1;
-		duration = 8;
-		mem_set_byte(cpu_get_HL(), regs.A);
-		break;
-
-	case 0x78: // LD A,B
-		length = 1;
-		duration = 4;
-		regs.A = regs.B;
-		break;
-
-	case 0x79: // LD A,C
-		length = 1;
-		duration = 4;
-		regs.A = regs.C;
-		break;
-
-	case 0x7A: // LD A,D
-		length = 1;
-		duration = 4;
-		regs.A = regs.D;
-		break;
-
-	case 0x7B: // LD A,E
-		length = 1;
-		duration = 4;
-		regs.A = regs.E;
-		break;
-
-	case 0x7C: // LD A,H
-		length = 1;
-		duration = 4;
-		regs.A = regs.H;
-		break;
-
-	case 0x7D: // LD A,L
-		length = 1;
-		duration = 4;
-		regs.A = regs.L;
-		break;
-
-	case 0x7E: // LD A,(HL)
-		length = 1;
-		duration = 4;
-		regs.A = mem_get_byte(cpu_get_HL());
-		break;
-
-	case 0x7F: // LD A,A
-		length = 1;
-		duration = 4;
-		regs.A = regs.A;
-		break;
-
-	// 0x8X ////////////////////////////////////////////////////////////////
-	case 0x80: // ADD A,B
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.B);
-		break;
-
-	case 0x81: // ADD A,C
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.C);
-		break;
-
-	case 0x82: // ADD A,D
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.D);
-		break;
-
-	case 0x83: // ADD A,E
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.E);
-		break;
-
-	case 0x84: // ADD A,H
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.H);
-		break;
-
-	case 0x85: // ADD A,L
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.L);
-		break;
-
-	case 0x86: // ADD A,(HL)
-		length = 1;
-		duration = 8;
-		ADD_to_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0x87: // ADD A,A
-		length = 1;
-		duration = 4;
-		ADD_to_A(regs.A);
-		break;
-
-	case 0x88: // ADC A,B
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.B);
-		break;
-
-	case 0x89: // ADC A,C
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.C);
-		break;
-
-	case 0x8A: // ADC A,D
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.D);
-		break;
-
-	case 0x8B: // ADC A,E
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.E);
-		break;
-
-	case 0x8C: // ADC A,H
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.H);
-		break;
-
-	case 0x8D: // ADC A,L
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.L);
-		break;
-
-	case 0x8E: // ADC A,(HL)
-		length = 1;
-		duration = 8;
-		ADC_to_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0x8F: // ADC A,A
-		length = 1;
-		duration = 4;
-		ADC_to_A(regs.A);
-		break;
-
-	// 0x9X ////////////////////////////////////////////////////////////////
-	case 0x90: // SUB A,B
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.B);
-		break;
-
-	case 0x91: // SUB A,C
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.C);
-		break;
-
-	case 0x92: // SUB A,D
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.D);
-		break;
-
-	case 0x93: // SUB A,E
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.E);
-		break;
-
-	case 0x94: // SUB A,H
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.H);
-		break;
-
-	case 0x95: // SUB A,L
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.L);
-		break;
-
-	case 0x96: // SUB A,(HL)
-		length = 1;
-		duration = 8;
-		SUB_to_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0x97: // SUB A,A
-		length = 1;
-		duration = 4;
-		SUB_to_A(regs.A);
-		break;
-
-	case 0x98: // SBC A,B
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.B);
-		break;
-
-	case 0x99: // SBC A,C
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.C);
-		break;
-
-	case 0x9A: // SBC A,D
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.D);
-		break;
-
-	case 0x9B: // SBC A,E
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.E);
-		break;
-
-	case 0x9C: // SBC A,H
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.H);
-		break;
-
-	case 0x9D: // SBC A,L
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.L);
-		break;
-
-	case 0x9E: // SBC A,(HL)
-		length = 1;
-		duration = 8;
-		SBC_to_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0x9F: // SBC A,A
-		length = 1;
-		duration = 4;
-		SBC_to_A(regs.A);
-		break;
-
-	// 0xAX ////////////////////////////////////////////////////////////////
-	case 0xA0: // AND A,B
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.B);
-		break;
-
-	case 0xA1: // AND A,C
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.C);
-		break;
-
-	case 0xA2: // AND A,D
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.D);
-		break;
-
-	case 0xA3: // AND A,E
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.E);
-		break;
-
-	case 0xA4: // AND A,H
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.H);
-		break;
-
-	case 0xA5: // AND A,L
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.L);
-		break;
-
-	case 0xA6: // AND A,(HL)
-		length = 1;
-		duration = 8;
-		AND_with_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0xA7: // AND A,A
-		length = 1;
-		duration = 4;
-		AND_with_A(regs.A);
-		break;
-
-	case 0xA8: // XOR A,B
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.B);
-		break;
-
-	case 0xA9: // XOR A,C
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.C);
-		break;
-
-	case 0xAA: // XOR A,D
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.D);
-		break;
-
-	case 0xAB: // XOR A,E
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.E);
-		break;
-
-	case 0xAC: // XOR A,H
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.H);
-		break;
-
-	case 0xAD: // XOR A,L
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.L);
-		break;
-
-	case 0xAE: // XOR A,(HL)
-		length = 1;
-		duration = 8;
-		XOR_with_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0xAF: // XOR A,A
-		length = 1;
-		duration = 4;
-		XOR_with_A(regs.A);
-		break;
-
-	// 0xBX ////////////////////////////////////////////////////////////////
-	case 0xB0: // OR A,B
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.B);
-		break;
-
-	case 0xB1: // OR A,C
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.C);
-		break;
-
-	case 0xB2: // OR A,D
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.D);
-		break;
-
-	case 0xB3: // OR A,E
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.E);
-		break;
-
-	case 0xB4: // OR A,H
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.H);
-		break;
-
-	case 0xB5: // OR A,L
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.L);
-		break;
-
-	case 0xB6: // OR A,(HL)
-		length = 1;
-		duration = 8;
-		OR_with_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0xB7: // OR A,A
-		length = 1;
-		duration = 4;
-		OR_with_A(regs.A);
-		break;
-
-	case 0xB8: // XOR A,B
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.B);
-		break;
-
-	case 0xB9: // CP A,C
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.C);
-		break;
-
-	case 0xBA: // CP A,D
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.D);
-		break;
-
-	case 0xBB: // CP A,E
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.E);
-		break;
-
-	case 0xBC: // CP A,H
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.H);
-		break;
-
-	case 0xBD: // CP A,L
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.L);
-		break;
-
-	case 0xBE: // CP A,(HL)
-		length = 1;
-		duration = 8;
-		CP_with_A(mem_get_byte(cpu_get_HL()));
-		break;
-
-	case 0xBF: // CP A,A
-		length = 1;
-		duration = 4;
-		CP_with_A(regs.A);
-		break;
-
-	// 0xCX ////////////////////////////////////////////////////////////////
-	case 0xC0: // RET NZ
-		length = 1;
-		if(cpu_get_flag(FLAG_ZERO) == FALSE) {
-			duration = 20;
-			// TODO: not sure is POP is needed
-			cpu_set_PC(SP_pop());
-			add_lg = 0;
-		}
-		else {
-			duration = 8;
-		}
-		break;
-
-	case 0xC1: // POP BC
-		length = 1;
-		duration = 12;
-		cpu_set_BC(SP_pop());
-		break;
-
-	case 0xC2: // JP NZ,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_ZERO) == FALSE) {
-			duration = 16;
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xC3: // JP a16
-		length = 3;
-		duration = 16;
-		cpu_set_PC(u16);
-		add_lg = 0;
-		break;
-
-	case 0xC4: // CALL NZ,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_ZERO) == FALSE) {
-			duration = 24;
-			SP_push(cpu_get_PC());
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xC5: // PUSH BC
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_BC());
-		break;
-
-	case 0xC6: // ADD A,d8
-		length = 2;
-		duration = 8;
-		ADD_to_A(mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0xC7: // RST 00H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0000);
-		break;
-
-	case 0xC8: // RET Z
-		length = 1;
-		if(cpu_get_flag(FLAG_ZERO) == TRUE) {
-			duration = 20;
-			// TODO: not sure is POP is needed
-			cpu_set_PC(SP_pop());
-			add_lg = 0;
-		}
-		else {
-			duration = 8;
-		}
-		break;
+		gb->cpu.regs.PC += 2;
+		op->add_lg = 0;
+	}
+}
 
-	case 0xC9: // RET
-		length = 1;
-		duration = 16;
-		// TODO: not sure is POP is needed
-		cpu_set_PC(SP_pop());
-		add_lg = 0;
-		break;
-
-	case 0xCA: // JP Z,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_ZERO) == TRUE) {
-			duration = 16;
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xCB: // PREFIX CB => TODO
-		length = 2;
-		duration = 8;	// TODO: adjust for some CB instruction which are 16
-		cpu_exec_opcode_CB(mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0xCC: // CALL Z,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_ZERO) == TRUE) {
-			duration = 24;
-			SP_push(cpu_get_PC());
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xCD: // CALL a16
-		length = 3;
-		duration = 24;
-		SP_push(cpu_get_PC() + 3);
-		cpu_set_PC(u16);
-		add_lg = 0;
-		break;
-
-	case 0xCE: // ADC A,d8
-		length = 2;
-		duration = 8;
-		ADC_to_A(mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0xCF: // RST 08H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0008);
-		add_lg = 0;
-		break;
-
-	// 0xDX ////////////////////////////////////////////////////////////////
-	case 0xD0: // RET NC
-		length = 1;
-		if(cpu_get_flag(FLAG_CARRY) == FALSE) {
-			duration = 20;
-			// TODO: not sure is POP is needed
-			cpu_set_PC(SP_pop());
-			add_lg = 0;
-		}
-		else {
-			duration = 8;
-		}
-		break;
-
-	case 0xD1: // POP DE
-		length = 1;
-		duration = 12;
-		cpu_set_DE(SP_pop());
-		break;
-
-	case 0xD2: // JP NC,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_CARRY) == FALSE) {
-			duration = 16;
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xD4: // CALL NC,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_CARRY) == FALSE) {
-			duration = 24;
-			SP_push(cpu_get_PC());
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
-		}
-		break;
-
-	case 0xD5: // PUSH DE
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_DE());
-		break;
-
-	case 0xD6: // SUB A,d8
-		length = 2;
-		duration = 8;
-		SUB_to_A(u8);
-		break;
-
-	case 0xD7: // RST 10H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0010);
-		add_lg = 0;
-		break;
-
-	case 0xD8: // RET C
-		length = 1;
-		if(cpu_get_flag(FLAG_CARRY) == TRUE) {
-			duration = 20;
-			// TODO: not sure is POP is needed
-			cpu_set_PC(SP_pop());
-			add_lg = 0;
-		}
-		else {
-			duration = 8;
-		}
-		break;
+// 0x21: LD HL,d16
+static void op_LD_HL_d16(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_HL(gb, op->u16);
+}
 
-	case 0xD9: // RETI
-		length = 1;
-		duration = 16;
-		// TODO: not sure is POP is needed
-		cpu_set_PC(SP_pop());
-		cpu_interrupts_enabled = 1;
-		add_lg = 0;
-		break;
-
-	case 0xDA: // JP C,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_CARRY) == TRUE) {
-			duration = 16;
-			cpu_set_PC(u16);
-			add_lg = 0;
-		}
-		else {
-			duration = 12;
+// 0x22: LD (HL+),A
+static void op_LD_mHLI_A(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u8(gb, cpu_get_HL(gb), gb->cpu.regs.A);
+	cpu_set_HL(gb, cpu_get_HL(gb) + 1);
+}
+
+// 0x23: INC HL
+static void op_INC_HL(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_HL(gb, cpu_get_HL(gb) + 1);
+}
+
+// 0x24: INC H
+static void op_INC_H(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.H);
+}
+
+// 0x25: DEC H
+static void op_DEC_H(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.H);
+}
+
+// 0x26: LD H,d8
+static void op_LD_H_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.H, op->u8);
+}
+
+// 0x27: DAA
+static void op_DAA(struct gb *gb, struct cpu_op *op)
+{
+	uint8_t D1 = gb->cpu.regs.A >> 4;
+	uint8_t D2 = gb->cpu.regs.A & 0x0F;
+	if (cpu_get_flag(gb, FLAG_SUB)) {
+		if (cpu_get_flag(gb, FLAG_SUB) | D2 > 9)
+			D2 -= 6;
+		if (cpu_get_flag(gb, FLAG_CARRY))
+			D1 -= 6;
+		if (D1 > 9) {
+			D1 -= 6;
+			cpu_set_flag(gb, FLAG_CARRY, TRUE);
 		}
-		break;
-
-	case 0xDC: // CALL C,a16
-		length = 3;
-		if(cpu_get_flag(FLAG_CARRY) == TRUE) {
-			duration = 24;
-			SP_push(cpu_get_PC());
-			cpu_set_PC(u16);
-			add_lg = 0;
+	} else {
+		if (cpu_get_flag(gb, FLAG_HALF_CARRY))
+			D2 += 6;
+		if (cpu_get_flag(gb, FLAG_CARRY))
+			D1 += 6;
+		if (D2 > 9) {
+			D2 -= 10;
+			D1++;
 		}
-		else {
-			duration = 12;
+		if (D1 > 9) {
+			D1 -= 10;
+			cpu_set_flag(gb, FLAG_CARRY, TRUE);
 		}
-		break;
-
-	case 0xDE: // SDC A,d8
-		length = 2;
-		duration = 8;
-		SBC_to_A(mem_get_byte(regs.PC + 1));
-		break;
-
-	case 0xDF: // RST 18H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0018);
-		add_lg = 0;
-		break;
-
-	// 0xEX ////////////////////////////////////////////////////////////////
-	case 0xE0: // LDH (a8),A
-		length = 2;
-		duration = 12;
-		mem_set_byte(0xFF00 + u8, regs.A);
-		break;
-
-	case 0xE1: // POP HL
-		length = 1;
-		duration = 12;
-		cpu_set_HL(SP_pop());
-		break;
-
-	case 0xE2: // LD (C),A
-		length = 1;
-		duration = 8;
-		LD_mem_u8(0xFF00 + cpu_get_C(), regs.A);
-		break;
-
-	case 0xE5: // PUSH HL
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_HL());
-		break;
-
-	case 0xE6: // AND d8
-		length = 2;
-		duration = 8;
-		AND_with_A(u8);
-		break;
-
-	case 0xE7: // RST 20H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0020);
-		add_lg = 0;
-		break;
-
-	case 0xE8: // ADD SP,r8
-		length = 2;
-		duration = 16;
-
-		r8 = (int8_t) u8;
-
-		cpu_set_SP((uint16_t)(cpu_get_SP() + (int16_t)r8));
-
-		cpu_set_flag(FLAG_ZERO, FALSE);
-		cpu_set_flag(FLAG_SUB, FALSE);
-
-		// TODO: test carry corncases
-		cpu_set_flag(FLAG_HALF_CARRY,
-		     (regs.SP & 0x0FFF) + r8 > 0x0FFF ? TRUE : FALSE);
-
-		cpu_set_flag(FLAG_CARRY,
-		     (regs.SP & 0xFFFF) + r8 > 0xFFFF ? TRUE : FALSE);
-
-		break;
-
-	case 0xE9: // JP (HL)
-		length = 1;
-		duration = 4;
-		cpu_set_PC(cpu_get_HL());
-		add_lg = 0;
-		break;
-
-	case 0xEA: // LD (a16),A
-		length = 3;
-		duration = 16;
-		LD_mem_u8(u16, regs.A);
-		break;
-
-	case 0xEE: // XOR d8
-		length = 2;
-		duration = 8;
-		XOR_with_A(u16);
-		break;
-
-	case 0xEF: // RST 28H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0028);
-		add_lg = 0;
-		break;
-
-	// 0xFX ////////////////////////////////////////////////////////////////
-	case 0xF0: // LDH A,(a8)
-		length = 2;
-		duration = 12;
-		regs.A = mem_get_byte(0xFF00 | u8);
-		break;
-
-	case 0xF1: // POP AF
-		length = 1;
-		duration = 12;
-		cpu_set_AF(SP_pop());
-		/*cpu_set_flag(FLAG_ZERO, TRUE);
-		cpu_set_flag(FLAG_SUB, TRUE);
-		cpu_set_flag(FLAG_HALF_CARRY, TRUE);
-		cpu_set_flag(FLAG_CARRY, TRUE);*/
-		break;
-
-	case 0xF2: // LD (C),A
-		length = 2;
-		duration = 8;
-		regs.A = mem_get_byte(0xFF00 + cpu_get_C());
-		break;
-
-	case 0xF3: // DI
-		length = 1;
-		duration = 4;
-		cpu_interrupts_enabled = 0;
-		break;
-
-	case 0xF5: // PUSH AF
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_AF());
-		break;
-
-	case 0xF6: // OR d8
-		length = 2;
-		duration = 8;
-		OR_with_A(u8);
-		break;
-
-	case 0xF7: // RST 30H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0030);
-		add_lg = 0;
-		break;
-
-	case 0xF8: // LD HL,SP+r8
-		length = 2;
-		duration = 12;
-		r8 = (int8_t) u8;
-		cpu_set_flag(FLAG_ZERO, FALSE);
-		cpu_set_flag(FLAG_SUB, FALSE);
-		
-		// TODO: test carry corner cases
-		cpu_set_flag(FLAG_HALF_CARRY,
-		     (regs.SP & 0x0FFF) + r8 > 0x0FFF ? TRUE : FALSE);
-		cpu_set_flag(FLAG_CARRY,
-		     (regs.SP & 0xFFFF) + r8 > 0xFFFF ? TRUE : FALSE);
-		
-		cpu_set_HL(cpu_get_SP() + (int8_t)u8);
-		break;
-
-	case 0xF9: // LD SP,HL
-		length = 1;
-		duration = 8;
-		cpu_set_SP(cpu_get_HL());
-		break;
-
-	case 0xFA: // LD A,(a16)
-		length = 3;
-		duration = 16;
-		regs.A = mem_get_byte(u16);
-		break;
-
-	case 0xFB: // EI
-		length = 1;
-		duration = 4;
-		cpu_interrupts_enabled = 1;
-		break;
-
-	case 0xFE: // CP d8
-		length = 2;
-		duration = 8;
-		CP_with_A(u8);
-		break;
-
-	case 0xFF: // RST 38H
-		length = 1;
-		duration = 16;
-		SP_push(cpu_get_PC()+1);
-		cpu_set_PC(0x0038);
-		add_lg = 0;
-		break;
+	}
+	gb->cpu.regs.A = ((D1 << 4) & 0xF0) | (D2 & 0x0F);
+	cpu_set_flag(gb, FLAG_ZERO, (gb->cpu.regs.A == 0));
+	cpu_set_flag(gb, FLAG_HALF_CARRY, FALSE);
+}
+
+// 0x28: JR Z,r8
+static void op_JR_Z_r8(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO)) {
+		op->duration = 12;
+		int8_t i8 = (int8_t)op->u8;
+		gb->cpu.regs.PC = (uint16_t)(
+			(int16_t)gb->cpu.regs.PC +
+			(int16_t)i8); // TODO: check if final PC value is right
+		op->add_lg = 0;
+		gb->cpu.regs.PC += 2;
+	}
+}
 
+// 0x29: ADD HL,HL
+static void op_ADD_HL_HL(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_HL(gb, cpu_get_HL(gb));
+}
+
+// 0x2A: LD A,(HL+)
+static void op_LD_A_mHLI(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.A, cpu_read(gb, cpu_get_HL(gb)));
+	cpu_set_HL(gb, cpu_get_HL(gb) + 1);
+}
 
+// 0x2B: DEC HL
+static void op_DEC_HL(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_HL(gb, cpu_get_HL(gb) - 1);
+}
 
-	default:
-		printf("[ERROR][%s:%d] unkown opcode 0x%x!\n", __func__,
-		       __LINE__, opcode);
-		exit(0);
+// 0x2C: INC L
+static void op_INC_L(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.L);
+}
+
+// 0x2D: DEC L
+static void op_DEC_L(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.L);
+}
+
+// 0x2E: LD L,d8
+static void op_LD_L_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.L, op->u8);
+}
+
+// 0x2F: CPL
+static void op_CPL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = ~gb->cpu.regs.A;
+	cpu_set_flag(gb, FLAG_SUB, TRUE);
+	cpu_set_flag(gb, FLAG_HALF_CARRY, TRUE);
+}
+
+// 0x3X ////////////////////////////////////////////////////////////////
+
+// 0x30: JR NC,r8
+static void op_JR_NC_r8(struct gb *gb, struct cpu_op *op)
+{
+	if (!cpu_get_flag(gb, FLAG_CARRY)) {
+		op->duration = 12;
+		int8_t i8 = (int8_t)op->u8;
+		gb->cpu.regs.PC = (uint16_t)(
+			(int16_t)gb->cpu.regs.PC +
+			(int16_t)i8); // TODO: check if final PC value is right
+		op->add_lg = 0;
+		gb->cpu.regs.PC += 2;
 	}
+}
 
+// 0x31: LD SP,d16
+static void op_LD_SP_d16(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_SP(gb, op->u16);
+}
 
+// 0x32: LD (HL-),A
+static void op_LD_mHLD_A(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u8(gb, cpu_get_HL(gb), gb->cpu.regs.A);
+	cpu_set_HL(gb, cpu_get_HL(gb) - 1);
+}
 
-	// TOOD: wait cycles here ?
+// 0x33: INC SP
+static void op_INC_SP(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_SP(gb, cpu_get_SP(gb) + 1);
+}
 
-	if (length == 0 || duration == 0)
-		printf("[ERROR][%s:%d] invalid opcode length or duration\n",
-		       __func__, __LINE__);
+// 0x34: INC (HL)
+static void op_INC_mHL(struct gb *gb, struct cpu_op *op)
+{
+	// one read and one write, as the hardware does
+	uint8_t val = cpu_read(gb, cpu_get_HL(gb));
 
-	*opcode_length = length;
-	*opcode_duration = duration;
+	INC_u8(gb, &val);
+	cpu_write(gb, cpu_get_HL(gb), val);
+}
 
-	if(add_lg)
-        cpu_set_PC(cpu_get_PC() + length);
+// 0x35: DEC (HL)
+static void op_DEC_mHL(struct gb *gb, struct cpu_op *op)
+{
+	uint8_t val = cpu_read(gb, cpu_get_HL(gb));
 
-	return 0;
+	DEC_u8(gb, &val);
+	cpu_write(gb, cpu_get_HL(gb), val);
 }
 
-static uint8_t cpu_exec_opcode_CB(uint8_t opcode)
+// 0x36: LD (HL),d8
+static void op_LD_mHL_d8(struct gb *gb, struct cpu_op *op)
 {
-	uint8_t u8;
+	LD_mem_u8(gb, cpu_get_HL(gb), op->u8);
+}
 
-	switch (opcode) {
-	// 0x0X ////////////////////////////////////////////////////////////////
-	case 0x00: // RLC B
-		RLC(&regs.B);
-		break;
-
-	case 0x01: // RLC C
-		RLC(&regs.C);
-		break;
-
-	case 0x02: // RLC D
-		RLC(&regs.D);
-		break;
-
-	case 0x03: // RLC E
-		RLC(&regs.E);
-		break;
-
-	case 0x04: // RLC H
-		RLC(&regs.H);
-		break;
-
-	case 0x05: // RLC L
-		RLC(&regs.L);
-		break;
-
-	case 0x06: // RLC (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		RLC(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x07: // RLC A
-		RLC(&regs.A);
-		break;
-
-	case 0x08: // RRC B
-		RRC(&regs.B);
-		break;
-
-	case 0x09: // RRC C
-		RRC(&regs.C);
-		break;
-
-	case 0x0A: // RRC D
-		RRC(&regs.D);
-		break;
-
-	case 0x0B: // RRC E
-		RRC(&regs.E);
-		break;
-
-	case 0x0C: // RRC H
-		RRC(&regs.H);
-		break;
-
-	case 0x0D: // RRC L
-		RRC(&regs.L);
-		break;
-
-	case 0x0E: // RRC (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		RRC(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x0F: // RRC A
-		RRC(&regs.A);
-		break;		
-
-	// 0x1X ////////////////////////////////////////////////////////////////
-	case 0x10: // RL B
-		RL(&regs.B);
-		break;
-
-	case 0x11: // RL C
-		RL(&regs.C);
-		break;
-
-	case 0x12: // RL D
-		RL(&regs.D);
-		break;
-
-	case 0x13: // RL E
-		RL(&regs.E);
-		break;
-
-	case 0x14: // RL H
-		RL(&regs.H);
-		break;
-
-	case 0x15: // RL L
-		RL(&regs.L);
-		break;
-
-	case 0x16: // RL (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		RL(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x17: // RL A
-		RL(&regs.A);
-		break;
-
-	case 0x18: // RR B
-		RR(&regs.B);
-		break;
-
-	case 0x19: // RR C
-		RR(&regs.C);
-		break;
-
-	case 0x1A: // RR D
-		RR(&regs.D);
-		break;
-
-	case 0x1B: // RR E
-		RR(&regs.E);
-		break;
-
-	case 0x1C: // RR H
-		RR(&regs.H);
-		break;
-
-	case 0x1D: // RR L
-		RR(&regs.L);
-		break;
-
-	case 0x1E: // RR (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		RR(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x1F: // RR A
-		RR(&regs.A);
-		break;	
-
-	// 0x2X ////////////////////////////////////////////////////////////////
-	case 0x20: // SLA B
-		SLA(&regs.B);
-		break;
-
-	case 0x21: // SLA C
-		SLA(&regs.C);
-		break;
-
-	case 0x22: // SLA D
-		SLA(&regs.D);
-		break;
-
-	case 0x23: // SLA E
-		SLA(&regs.E);
-		break;
-
-	case 0x24: // SLA H
-		SLA(&regs.H);
-		break;
-
-	case 0x25: // SLA L
-		SLA(&regs.L);
-		break;
-
-	case 0x26: // SLA (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		SLA(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x27: // SLA A
-		SLA(&regs.A);
-		break;
-
-	case 0x28: // SRA B
-		SRA(&regs.B);
-		break;
-
-	case 0x29: // SRA C
-		SRA(&regs.C);
-		break;
-
-	case 0x2A: // SRA D
-		SRA(&regs.D);
-		break;
-
-	case 0x2B: // SRA E
-		SRA(&regs.E);
-		break;
-
-	case 0x2C: // SRA H
-		SRA(&regs.H);
-		break;
-
-	case 0x2D: // SRA L
-		SRA(&regs.L);
-		break;
-
-	case 0x2E: // SRA (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		SRA(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x2F: // SRA A
-		SRA(&regs.A);
-		break;	
-
-	// 0x3X ////////////////////////////////////////////////////////////////
-	case 0x30: // SWAP B
-		SWAP(&regs.B);
-		break;
-
-	case 0x31: // SWAP C
-		SWAP(&regs.C);
-		break;
-
-	case 0x32: // SWAP D
-		SWAP(&regs.D);
-		break;
-
-	case 0x33: // SWAP E
-		SWAP(&regs.E);
-		break;
-
-	case 0x34: // SWAP H
-		SWAP(&regs.H);
-		break;
-
-	case 0x35: // SWAP L
-		SWAP(&regs.L);
-		break;
-
-	case 0x36: // SWAP (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		SWAP(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x37: // SWAP A
-		SWAP(&regs.A);
-		break;
-
-	case 0x38: // SRL B
-		SRL(&regs.B);
-		break;
-
-	case 0x39: // SRL C
-		SRL(&regs.C);
-		break;
-
-	case 0x3A: // SRL D
-		SRL(&regs.D);
-		break;
-
-	case 0x3B: // SRL E
-		SRL(&regs.E);
-		break;
-
-	case 0x3C: // SRL H
-		SRL(&regs.H);
-		break;
-
-	case 0x3D: // SRL L
-		SRL(&regs.L);
-		break;
-
-	case 0x3E: // SRL (HL)
-		u8 = mem_get_byte(cpu_get_HL()); 	
-		SRL(&u8);
-		mem_set_byte(cpu_get_HL(), u8);
-		break;
-
-	case 0x3F: // SRL A
-		SRL(&regs.A);
-		break;	
+// 0x37: SCF
+static void op_SCF(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_flag(gb, FLAG_SUB, FALSE);
+	cpu_set_flag(gb, FLAG_HALF_CARRY, FALSE);
+	cpu_set_flag(gb, FLAG_CARRY, TRUE);
+}
 
-	default:
-		{
-		uint8_t reg2test = (opcode - 0x40) % 8;
-		//printf("[opcode=0x%x] bit2test = %d, reg2test = %d\n", opcode, bit2test, reg2test);
-		uint8_t *p_reg = NULL;
-		uint16_t opcode_on_addr = 0;
-		switch (reg2test) {
-			case 0:
-				p_reg = &regs.B;
-				break;
-			case 1:
-				p_reg = &regs.C;
-				break;
-			case 2:
-				p_reg = &regs.D;
-				break;
-			case 3:
-				p_reg = &regs.E;
-				break;
-			case 4:
-				p_reg = &regs.H;
-				break;
-			case 5:
-				p_reg = &regs.L;
-				break;
-			case 6:
-				opcode_on_addr = 1;
-				break;
-			case 7:
-				p_reg = &regs.A;
-				break;
-		}
-		if (opcode >= 0x40 && opcode <= 0x7F) {
-			uint8_t bit2test = (opcode - 0x40) / 8;
-
-			if(opcode_on_addr) {
-				u8 = mem_get_byte(cpu_get_HL()); 	
-				BIT(bit2test, &u8);
-			} else {
-				BIT(bit2test, p_reg);
-			}
-		}
-		else if (opcode >= 0x80 && opcode <= 0xBF) {
-			uint8_t bit2test = (opcode - 0x80) / 8;
-
-			if(opcode_on_addr) {
-				u8 = mem_get_byte(cpu_get_HL()); 	
-				RES(bit2test, &u8);
-				mem_set_byte(cpu_get_HL(), u8);
-			} else {
-				RES(bit2test, p_reg);
-			}
-		}
-		else if (opcode >= 0xC0 && opcode <= 0xFF) {
-			uint8_t bit2test = (opcode - 0xC0) / 8;
-
-			if(opcode_on_addr) {
-				u8 = mem_get_byte(cpu_get_HL()); 	
-				SET(bit2test, &u8);
-				mem_set_byte(cpu_get_HL(), u8);
-			} else {
-				SET(bit2test, p_reg);
-			}
-		}
-		else {
-			printf("[ERROR][%s:%d] unkown opcode 0x%x!\n", __func__,
-			    __LINE__, opcode);
-		}
-		break;
+// 0x38: JR C,r8
+static void op_JR_C_r8(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY)) {
+		op->duration = 12;
+		int8_t i8 = (int8_t)op->u8;
+		gb->cpu.regs.PC = (uint16_t)(
+			(int16_t)gb->cpu.regs.PC +
+			(int16_t)i8); // TODO: check if final PC value is right
+		op->add_lg = 0;
+		gb->cpu.regs.PC += 2;
+	}
+}
+
+// 0x39: ADD HL,SP
+static void op_ADD_HL_SP(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_HL(gb, cpu_get_SP(gb));
+}
+
+// 0x3A: LD A,(HL-)
+static void op_LD_A_mHLD(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.A, cpu_read(gb, cpu_get_HL(gb)));
+	cpu_set_HL(gb, cpu_get_HL(gb) - 1);
+}
+
+// 0x3B: DEC SP
+static void op_DEC_SP(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_SP(gb, cpu_get_SP(gb) - 1);
+}
+
+// 0x3C: INC A
+static void op_INC_A(struct gb *gb, struct cpu_op *op)
+{
+	INC_u8(gb, &gb->cpu.regs.A);
+}
+
+// 0x3D: DEC A
+static void op_DEC_A(struct gb *gb, struct cpu_op *op)
+{
+	DEC_u8(gb, &gb->cpu.regs.A);
+}
+
+// 0x3E: LD A,d8
+static void op_LD_A_d8(struct gb *gb, struct cpu_op *op)
+{
+	LD_reg_u8(&gb->cpu.regs.A, op->u8);
+}
+
+// 0x3F: CCF
+static void op_CCF(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_flag(gb, FLAG_SUB, FALSE);
+	cpu_set_flag(gb, FLAG_HALF_CARRY, FALSE);
+	cpu_set_flag(gb, FLAG_CARRY,
+		     cpu_get_flag(gb, FLAG_CARRY) ? FALSE : TRUE);
+}
+
+// 0x4X ////////////////////////////////////////////////////////////////
+
+// 0x40: LD B,B
+static void op_LD_B_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.B;
+}
+
+// 0x41: LD B,C
+static void op_LD_B_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.C;
+}
+
+// 0x42: LD B,D
+static void op_LD_B_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.D;
+}
+
+// 0x43: LD B,E
+static void op_LD_B_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.E;
+}
+
+// 0x44: LD B,H
+static void op_LD_B_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.H;
+}
+
+// 0x45: LD B,L
+static void op_LD_B_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.L;
+}
+
+// 0x46: LD B,(HL)
+static void op_LD_B_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x47: LD B,A
+static void op_LD_B_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.B = gb->cpu.regs.A;
+}
+
+// 0x48: LD C,B
+static void op_LD_C_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.B;
+}
+
+// 0x49: LD C,C
+static void op_LD_C_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.C;
+}
+
+// 0x4A: LD C,D
+static void op_LD_C_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.D;
+}
+
+// 0x4B: LD C,E
+static void op_LD_C_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.E;
+}
+
+// 0x4C: LD C,H
+static void op_LD_C_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.H;
+}
+
+// 0x4D: LD C,L
+static void op_LD_C_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.L;
+}
+
+// 0x4E: LD C,(HL)
+static void op_LD_C_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x4F: LD C,A
+static void op_LD_C_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.C = gb->cpu.regs.A;
+}
+
+// 0x5X ////////////////////////////////////////////////////////////////
+
+// 0x50: LD D,B
+static void op_LD_D_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.B;
+}
+
+// 0x51: LD D,C
+static void op_LD_D_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.C;
+}
+
+// 0x52: LD D,D
+static void op_LD_D_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.D;
+}
+
+// 0x53: LD D,E
+static void op_LD_D_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.E;
+}
+
+// 0x54: LD D,H
+static void op_LD_D_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.H;
+}
+
+// 0x55: LD D,L
+static void op_LD_D_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.L;
+}
+
+// 0x56: LD D,(HL)
+static void op_LD_D_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x57: LD D,A
+static void op_LD_D_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.D = gb->cpu.regs.A;
+}
+
+// 0x58: LD E,B
+static void op_LD_E_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.B;
+}
+
+// 0x59: LD E,C
+static void op_LD_E_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.C;
+}
+
+// 0x5A: LD E,D
+static void op_LD_E_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.D;
+}
+
+// 0x5B: LD E,E
+static void op_LD_E_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.E;
+}
+
+// 0x5C: LD E,H
+static void op_LD_E_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.H;
+}
+
+// 0x5D: LD E,L
+static void op_LD_E_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.L;
+}
+
+// 0x5E: LD E,(HL)
+static void op_LD_E_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x5F: LD E,A
+static void op_LD_E_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.E = gb->cpu.regs.A;
+}
+
+// 0x6X ////////////////////////////////////////////////////////////////
+
+// 0x60: LD H,B
+static void op_LD_H_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.B;
+}
+
+// 0x61: LD H,C
+static void op_LD_H_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.C;
+}
+
+// 0x62: LD H,D
+static void op_LD_H_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.D;
+}
+
+// 0x63: LD H,E
+static void op_LD_H_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.E;
+}
+
+// 0x64: LD H,H
+static void op_LD_H_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.H;
+}
+
+// 0x65: LD H,L
+static void op_LD_H_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.L;
+}
+
+// 0x66: LD H,(HL)
+static void op_LD_H_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x67: LD H,A
+static void op_LD_H_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.H = gb->cpu.regs.A;
+}
+
+// 0x68: LD L,B
+static void op_LD_L_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.B;
+}
+
+// 0x69: LD L,C
+static void op_LD_L_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.C;
+}
+
+// 0x6A: LD L,D
+static void op_LD_L_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.D;
+}
+
+// 0x6B: LD L,E
+static void op_LD_L_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.E;
+}
+
+// 0x6C: LD L,H
+static void op_LD_L_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.H;
+}
+
+// 0x6D: LD L,L
+static void op_LD_L_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.L;
+}
+
+// 0x6E: LD L,(HL)
+static void op_LD_L_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x6F: LD L,A
+static void op_LD_L_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.L = gb->cpu.regs.A;
+}
+
+// 0x7X ////////////////////////////////////////////////////////////////
+
+// 0x70: LD (HL),B
+static void op_LD_mHL_B(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.B);
+}
+
+// 0x71: LD (HL),C
+static void op_LD_mHL_C(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.C);
+}
+
+// 0x72: LD (HL),D
+static void op_LD_mHL_D(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.D);
+}
+
+// 0x73: LD (HL),E
+static void op_LD_mHL_E(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.E);
+}
+
+// 0x74: LD (HL),H
+static void op_LD_mHL_H(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.H);
+}
+
+// 0x75: LD (HL),L
+static void op_LD_mHL_L(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.L);
+}
+
+// 0x76: HALT
+static void op_HALT(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.run_state = CPU_HALTED;
+}
+
+// 0x77: LD (HL),A
+static void op_LD_mHL_A(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write(gb, cpu_get_HL(gb), gb->cpu.regs.A);
+}
+
+// 0x78: LD A,B
+static void op_LD_A_B(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.B;
+}
+
+// 0x79: LD A,C
+static void op_LD_A_C(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.C;
+}
+
+// 0x7A: LD A,D
+static void op_LD_A_D(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.D;
+}
+
+// 0x7B: LD A,E
+static void op_LD_A_E(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.E;
+}
+
+// 0x7C: LD A,H
+static void op_LD_A_H(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.H;
+}
+
+// 0x7D: LD A,L
+static void op_LD_A_L(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.L;
+}
+
+// 0x7E: LD A,(HL)
+static void op_LD_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = cpu_read(gb, cpu_get_HL(gb));
+}
+
+// 0x7F: LD A,A
+static void op_LD_A_A(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = gb->cpu.regs.A;
+}
+
+// 0x8X ////////////////////////////////////////////////////////////////
+
+// 0x80: ADD A,B
+static void op_ADD_A_B(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.B);
+}
+
+// 0x81: ADD A,C
+static void op_ADD_A_C(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.C);
+}
+
+// 0x82: ADD A,D
+static void op_ADD_A_D(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.D);
+}
+
+// 0x83: ADD A,E
+static void op_ADD_A_E(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.E);
+}
+
+// 0x84: ADD A,H
+static void op_ADD_A_H(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.H);
+}
+
+// 0x85: ADD A,L
+static void op_ADD_A_L(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.L);
+}
+
+// 0x86: ADD A,(HL)
+static void op_ADD_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0x87: ADD A,A
+static void op_ADD_A_A(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, gb->cpu.regs.A);
+}
+
+// 0x88: ADC A,B
+static void op_ADC_A_B(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.B);
+}
+
+// 0x89: ADC A,C
+static void op_ADC_A_C(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.C);
+}
+
+// 0x8A: ADC A,D
+static void op_ADC_A_D(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.D);
+}
+
+// 0x8B: ADC A,E
+static void op_ADC_A_E(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.E);
+}
+
+// 0x8C: ADC A,H
+static void op_ADC_A_H(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.H);
+}
+
+// 0x8D: ADC A,L
+static void op_ADC_A_L(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.L);
+}
+
+// 0x8E: ADC A,(HL)
+static void op_ADC_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0x8F: ADC A,A
+static void op_ADC_A_A(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, gb->cpu.regs.A);
+}
+
+// 0x9X ////////////////////////////////////////////////////////////////
+
+// 0x90: SUB A,B
+static void op_SUB_A_B(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.B);
+}
+
+// 0x91: SUB A,C
+static void op_SUB_A_C(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.C);
+}
+
+// 0x92: SUB A,D
+static void op_SUB_A_D(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.D);
+}
+
+// 0x93: SUB A,E
+static void op_SUB_A_E(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.E);
+}
+
+// 0x94: SUB A,H
+static void op_SUB_A_H(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.H);
+}
+
+// 0x95: SUB A,L
+static void op_SUB_A_L(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.L);
+}
+
+// 0x96: SUB A,(HL)
+static void op_SUB_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0x97: SUB A,A
+static void op_SUB_A_A(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, gb->cpu.regs.A);
+}
+
+// 0x98: SBC A,B
+static void op_SBC_A_B(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.B);
+}
+
+// 0x99: SBC A,C
+static void op_SBC_A_C(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.C);
+}
+
+// 0x9A: SBC A,D
+static void op_SBC_A_D(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.D);
+}
+
+// 0x9B: SBC A,E
+static void op_SBC_A_E(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.E);
+}
+
+// 0x9C: SBC A,H
+static void op_SBC_A_H(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.H);
+}
+
+// 0x9D: SBC A,L
+static void op_SBC_A_L(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.L);
+}
+
+// 0x9E: SBC A,(HL)
+static void op_SBC_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0x9F: SBC A,A
+static void op_SBC_A_A(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, gb->cpu.regs.A);
+}
+
+// 0xAX ////////////////////////////////////////////////////////////////
+
+// 0xA0: AND A,B
+static void op_AND_A_B(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.B);
+}
+
+// 0xA1: AND A,C
+static void op_AND_A_C(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.C);
+}
+
+// 0xA2: AND A,D
+static void op_AND_A_D(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.D);
+}
+
+// 0xA3: AND A,E
+static void op_AND_A_E(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.E);
+}
+
+// 0xA4: AND A,H
+static void op_AND_A_H(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.H);
+}
+
+// 0xA5: AND A,L
+static void op_AND_A_L(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.L);
+}
+
+// 0xA6: AND A,(HL)
+static void op_AND_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0xA7: AND A,A
+static void op_AND_A_A(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, gb->cpu.regs.A);
+}
+
+// 0xA8: XOR A,B
+static void op_XOR_A_B(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.B);
+}
+
+// 0xA9: XOR A,C
+static void op_XOR_A_C(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.C);
+}
+
+// 0xAA: XOR A,D
+static void op_XOR_A_D(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.D);
+}
+
+// 0xAB: XOR A,E
+static void op_XOR_A_E(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.E);
+}
+
+// 0xAC: XOR A,H
+static void op_XOR_A_H(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.H);
+}
+
+// 0xAD: XOR A,L
+static void op_XOR_A_L(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.L);
+}
+
+// 0xAE: XOR A,(HL)
+static void op_XOR_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0xAF: XOR A,A
+static void op_XOR_A_A(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, gb->cpu.regs.A);
+}
+
+// 0xBX ////////////////////////////////////////////////////////////////
+
+// 0xB0: OR A,B
+static void op_OR_A_B(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.B);
+}
+
+// 0xB1: OR A,C
+static void op_OR_A_C(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.C);
+}
+
+// 0xB2: OR A,D
+static void op_OR_A_D(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.D);
+}
+
+// 0xB3: OR A,E
+static void op_OR_A_E(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.E);
+}
+
+// 0xB4: OR A,H
+static void op_OR_A_H(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.H);
+}
+
+// 0xB5: OR A,L
+static void op_OR_A_L(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.L);
+}
+
+// 0xB6: OR A,(HL)
+static void op_OR_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0xB7: OR A,A
+static void op_OR_A_A(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, gb->cpu.regs.A);
+}
+
+// 0xB8: CP A,B
+static void op_CP_A_B(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.B);
+}
+
+// 0xB9: CP A,C
+static void op_CP_A_C(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.C);
+}
+
+// 0xBA: CP A,D
+static void op_CP_A_D(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.D);
+}
+
+// 0xBB: CP A,E
+static void op_CP_A_E(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.E);
+}
+
+// 0xBC: CP A,H
+static void op_CP_A_H(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.H);
+}
+
+// 0xBD: CP A,L
+static void op_CP_A_L(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.L);
+}
+
+// 0xBE: CP A,(HL)
+static void op_CP_A_mHL(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, cpu_read(gb, cpu_get_HL(gb)));
+}
+
+// 0xBF: CP A,A
+static void op_CP_A_A(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, gb->cpu.regs.A);
+}
+
+// 0xCX ////////////////////////////////////////////////////////////////
+
+// 0xC0: RET NZ
+static void op_RET_NZ(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == FALSE) {
+		op->duration = 20;
+		// TODO: not sure is POP is needed
+		cpu_set_PC(gb, SP_pop(gb));
+		op->add_lg = 0;
+	}
+}
+
+// 0xC1: POP BC
+static void op_POP_BC(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_BC(gb, SP_pop(gb));
+}
+
+// 0xC2: JP NZ,a16
+static void op_JP_NZ_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == FALSE) {
+		op->duration = 16;
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xC3: JP a16
+static void op_JP_a16(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_PC(gb, op->u16);
+	op->add_lg = 0;
+}
+
+// 0xC4: CALL NZ,a16
+static void op_CALL_NZ_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == FALSE) {
+		op->duration = 24;
+		SP_push(gb, cpu_get_PC(gb));
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xC5: PUSH BC
+static void op_PUSH_BC(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_BC(gb));
+}
+
+// 0xC6: ADD A,d8
+static void op_ADD_A_d8(struct gb *gb, struct cpu_op *op)
+{
+	ADD_to_A(gb, op->u8);
+}
+
+// 0xC7: RST 00h
+static void op_RST_00H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0000);
+	op->add_lg = 0;
+}
+
+// 0xC8: RET Z
+static void op_RET_Z(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == TRUE) {
+		op->duration = 20;
+		// TODO: not sure is POP is needed
+		cpu_set_PC(gb, SP_pop(gb));
+		op->add_lg = 0;
+	}
+}
+
+// 0xC9: RET
+static void op_RET(struct gb *gb, struct cpu_op *op)
+{
+	// TODO: not sure is POP is needed
+	cpu_set_PC(gb, SP_pop(gb));
+	op->add_lg = 0;
+}
+
+// 0xCA: JP Z,a16
+static void op_JP_Z_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == TRUE) {
+		op->duration = 16;
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xCB: PREFIX CB
+static void op_PREFIX_CB(struct gb *gb, struct cpu_op *op)
+{
+	cpu_exec_opcode_CB(gb, op, op->u8);
+}
+
+// 0xCC: CALL Z,a16
+static void op_CALL_Z_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_ZERO) == TRUE) {
+		op->duration = 24;
+		SP_push(gb, cpu_get_PC(gb));
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xCD: CALL a16
+static void op_CALL_a16(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb) + 3);
+	cpu_set_PC(gb, op->u16);
+	op->add_lg = 0;
+}
+
+// 0xCE: ADC A,d8
+static void op_ADC_A_d8(struct gb *gb, struct cpu_op *op)
+{
+	ADC_to_A(gb, op->u8);
+}
+
+// 0xCF: RST 08h
+static void op_RST_08H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0008);
+	op->add_lg = 0;
+}
+
+// 0xDX ////////////////////////////////////////////////////////////////
+
+// 0xD0: RET NC
+static void op_RET_NC(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == FALSE) {
+		op->duration = 20;
+		// TODO: not sure is POP is needed
+		cpu_set_PC(gb, SP_pop(gb));
+		op->add_lg = 0;
+	}
+}
+
+// 0xD1: POP DE
+static void op_POP_DE(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_DE(gb, SP_pop(gb));
+}
+
+// 0xD2: JP NC,a16
+static void op_JP_NC_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == FALSE) {
+		op->duration = 16;
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xD4: CALL NC,a16
+static void op_CALL_NC_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == FALSE) {
+		op->duration = 24;
+		SP_push(gb, cpu_get_PC(gb));
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xD5: PUSH DE
+static void op_PUSH_DE(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_DE(gb));
+}
+
+// 0xD6: SUB A,d8
+static void op_SUB_A_d8(struct gb *gb, struct cpu_op *op)
+{
+	SUB_to_A(gb, op->u8);
+}
+
+// 0xD7: RST 10h
+static void op_RST_10H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0010);
+	op->add_lg = 0;
+}
+
+// 0xD8: RET C
+static void op_RET_C(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == TRUE) {
+		op->duration = 20;
+		// TODO: not sure is POP is needed
+		cpu_set_PC(gb, SP_pop(gb));
+		op->add_lg = 0;
+	}
+}
+
+// 0xD9: RETI
+static void op_RETI(struct gb *gb, struct cpu_op *op)
+{
+	// TODO: not sure is POP is needed
+	cpu_set_PC(gb, SP_pop(gb));
+	gb->cpu.interrupts_enabled = 1;
+	op->add_lg = 0;
+}
+
+// 0xDA: JP C,a16
+static void op_JP_C_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == TRUE) {
+		op->duration = 16;
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xDC: CALL C,a16
+static void op_CALL_C_a16(struct gb *gb, struct cpu_op *op)
+{
+	if (cpu_get_flag(gb, FLAG_CARRY) == TRUE) {
+		op->duration = 24;
+		SP_push(gb, cpu_get_PC(gb));
+		cpu_set_PC(gb, op->u16);
+		op->add_lg = 0;
+	}
+}
+
+// 0xDE: SBC A,d8
+static void op_SBC_A_d8(struct gb *gb, struct cpu_op *op)
+{
+	SBC_to_A(gb, op->u8);
+}
+
+// 0xDF: RST 18h
+static void op_RST_18H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0018);
+	op->add_lg = 0;
+}
+
+// 0xEX ////////////////////////////////////////////////////////////////
+
+// 0xE0: LDH (a8),A
+static void op_LDH_ma8_A(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write_high(gb, op->u8, gb->cpu.regs.A);
+}
+
+// 0xE1: POP HL
+static void op_POP_HL(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_HL(gb, SP_pop(gb));
+}
+
+// 0xE2: LD (C),A
+static void op_LD_mC_A(struct gb *gb, struct cpu_op *op)
+{
+	cpu_write_high(gb, cpu_get_C(gb), gb->cpu.regs.A);
+}
+
+// 0xE5: PUSH HL
+static void op_PUSH_HL(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_HL(gb));
+}
+
+// 0xE6: AND d8
+static void op_AND_d8(struct gb *gb, struct cpu_op *op)
+{
+	AND_with_A(gb, op->u8);
+}
+
+// 0xE7: RST 20h
+static void op_RST_20H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0020);
+	op->add_lg = 0;
+}
+
+// 0xE8: ADD SP,r8
+static void op_ADD_SP_r8(struct gb *gb, struct cpu_op *op)
+{
+	int8_t r8 = (int8_t)op->u8;
+
+	cpu_set_SP(gb, (uint16_t)(cpu_get_SP(gb) + (int16_t)r8));
+
+	cpu_set_flag(gb, FLAG_ZERO, FALSE);
+	cpu_set_flag(gb, FLAG_SUB, FALSE);
+
+	// TODO: test carry corncases
+	cpu_set_flag(gb, FLAG_HALF_CARRY,
+	     (gb->cpu.regs.SP & 0x0FFF) + r8 > 0x0FFF ? TRUE : FALSE);
+
+	cpu_set_flag(gb, FLAG_CARRY,
+	     (gb->cpu.regs.SP & 0xFFFF) + r8 > 0xFFFF ? TRUE : FALSE);
+
+}
+
+// 0xE9: JP (HL)
+static void op_JP_mHL(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_PC(gb, cpu_get_HL(gb));
+	op->add_lg = 0;
+}
+
+// 0xEA: LD (a16),A
+static void op_LD_ma16_A(struct gb *gb, struct cpu_op *op)
+{
+	LD_mem_u8(gb, op->u16, gb->cpu.regs.A);
+}
+
+// 0xEE: XOR d8
+static void op_XOR_d8(struct gb *gb, struct cpu_op *op)
+{
+	XOR_with_A(gb, op->u16);
+}
+
+// 0xEF: RST 28h
+static void op_RST_28H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0028);
+	op->add_lg = 0;
+}
+
+// 0xFX ////////////////////////////////////////////////////////////////
+
+// 0xF0: LDH A,(a8)
+static void op_LDH_A_ma8(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = cpu_read_high(gb, op->u8);
+}
+
+// 0xF1: POP AF
+static void op_POP_AF(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_AF(gb, SP_pop(gb));
+	/*cpu_set_flag(gb, FLAG_ZERO, TRUE);
+	cpu_set_flag(gb, FLAG_SUB, TRUE);
+	cpu_set_flag(gb, FLAG_HALF_CARRY, TRUE);
+	cpu_set_flag(gb, FLAG_CARRY, TRUE);*/
+}
+
+// 0xF2: LD A,(C)
+static void op_LD_A_mC(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = cpu_read_high(gb, cpu_get_C(gb));
+}
+
+// 0xF3: DI
+static void op_DI(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.interrupts_enabled = 0;
+}
+
+// 0xF5: PUSH AF
+static void op_PUSH_AF(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_AF(gb));
+}
+
+// 0xF6: OR d8
+static void op_OR_d8(struct gb *gb, struct cpu_op *op)
+{
+	OR_with_A(gb, op->u8);
+}
+
+// 0xF7: RST 30h
+static void op_RST_30H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0030);
+	op->add_lg = 0;
+}
+
+// 0xF8: LD HL,SP+r8
+static void op_LD_HL_SP_r8(struct gb *gb, struct cpu_op *op)
+{
+	int8_t r8 = (int8_t)op->u8;
+	cpu_set_flag(gb, FLAG_ZERO, FALSE);
+	cpu_set_flag(gb, FLAG_SUB, FALSE);
+	
+	// TODO: test carry corner cases
+	cpu_set_flag(gb, FLAG_HALF_CARRY,
+	     (gb->cpu.regs.SP & 0x0FFF) + r8 > 0x0FFF ? TRUE : FALSE);
+	cpu_set_flag(gb, FLAG_CARRY,
+	     (gb->cpu.regs.SP & 0xFFFF) + r8 > 0xFFFF ? TRUE : FALSE);
+	
+	cpu_set_HL(gb, cpu_get_SP(gb) + (int8_t)op->u8);
+}
+
+// 0xF9: LD SP,HL
+static void op_LD_SP_HL(struct gb *gb, struct cpu_op *op)
+{
+	cpu_set_SP(gb, cpu_get_HL(gb));
+}
+
+// 0xFA: LD A,(a16)
+static void op_LD_A_ma16(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.regs.A = cpu_read(gb, op->u16);
+}
+
+// 0xFB: EI
+static void op_EI(struct gb *gb, struct cpu_op *op)
+{
+	gb->cpu.interrupts_enabled = 1;
+}
+
+// 0xFE: CP d8
+static void op_CP_d8(struct gb *gb, struct cpu_op *op)
+{
+	CP_with_A(gb, op->u8);
+}
+
+// 0xFF: RST 38h
+static void op_RST_38H(struct gb *gb, struct cpu_op *op)
+{
+	SP_push(gb, cpu_get_PC(gb)+1);
+	cpu_set_PC(gb, 0x0038);
+	op->add_lg = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// CB prefixed opcodes
+/////////////////////////////////////////////////////////////////////////////////////
+
+// CB opcodes are fully regular: bits 3-7 select the operation (and the bit
+// number for BIT/RES/SET) and bits 0-2 select the operand.
+struct cpu_opcode_CB {
+	void (*handler)(struct gb *gb, uint8_t bit, uint8_t *p_reg);
+	uint8_t write_back; // an (HL) operand has to be stored back to memory
+};
+
+static void CB_RLC(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	RLC(gb, p_reg);
+}
+
+static void CB_RRC(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	RRC(gb, p_reg);
+}
+
+static void CB_RL(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	RL(gb, p_reg);
+}
+
+static void CB_RR(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	RR(gb, p_reg);
+}
+
+static void CB_SLA(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	SLA(gb, p_reg);
+}
+
+static void CB_SRA(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	SRA(gb, p_reg);
+}
+
+static void CB_SWAP(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	SWAP(gb, p_reg);
+}
+
+static void CB_SRL(struct gb *gb, uint8_t bit, uint8_t *p_reg)
+{
+	SRL(gb, p_reg);
+}
+
+static const struct cpu_opcode_CB opcode_table_CB[32] = {
+	// 0x00 - 0x3F
+	{ CB_RLC, 1 }, { CB_RRC, 1 }, { CB_RL, 1 }, { CB_RR, 1 },
+	{ CB_SLA, 1 }, { CB_SRA, 1 }, { CB_SWAP, 1 }, { CB_SRL, 1 },
+	// 0x40 - 0x7F
+	{ BIT, 0 }, { BIT, 0 }, { BIT, 0 }, { BIT, 0 },
+	{ BIT, 0 }, { BIT, 0 }, { BIT, 0 }, { BIT, 0 },
+	// 0x80 - 0xBF
+	{ RES, 1 }, { RES, 1 }, { RES, 1 }, { RES, 1 },
+	{ RES, 1 }, { RES, 1 }, { RES, 1 }, { RES, 1 },
+	// 0xC0 - 0xFF
+	{ SET, 1 }, { SET, 1 }, { SET, 1 }, { SET, 1 },
+	{ SET, 1 }, { SET, 1 }, { SET, 1 }, { SET, 1 },
+};
+
+// offset of the operand in struct cpu_registers, -1 stands for (HL)
+static const int8_t operand_table_CB[8] = {
+	offsetof(struct cpu_registers, B), offsetof(struct cpu_registers, C),
+	offsetof(struct cpu_registers, D), offsetof(struct cpu_registers, E),
+	offsetof(struct cpu_registers, H), offsetof(struct cpu_registers, L),
+	-1,				   offsetof(struct cpu_registers, A),
+};
+
+// 8 cycles on a register, (HL) adds one M-cycle per access
+static void cpu_exec_opcode_CB(struct gb *gb, struct cpu_op *op,
+			       uint8_t opcode)
+{
+	const struct cpu_opcode_CB *entry = &opcode_table_CB[opcode >> 3];
+	int8_t operand = operand_table_CB[opcode & 0x07];
+	uint8_t bit = (opcode >> 3) & 0x07;
+	uint8_t u8;
+
+	if (operand >= 0) {
+		entry->handler(gb, bit, (uint8_t *)&gb->cpu.regs + operand);
+		return;
+	}
+
+	u8 = cpu_read(gb, cpu_get_HL(gb));
+	entry->handler(gb, bit, &u8);
+	op->duration = 12;
+	if (entry->write_back) {
+		cpu_write(gb, cpu_get_HL(gb), u8);
+		op->duration = 16;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// opcode dispatch
+/////////////////////////////////////////////////////////////////////////////////////
+
+struct cpu_opcode {
+	void (*handler)(struct gb *gb, struct cpu_op *op);
+	uint8_t length; // length in byte
+	uint8_t duration; // duration in clock cycles (branch not taken)
+};
+
+#define OPCODE_ENTRY(code, name, lg, dur) [code] = { op_##name, lg, dur },
+
+static const struct cpu_opcode opcode_table[0x100] = {
+	CPU_OPCODE_TABLE(OPCODE_ENTRY)
+};
+
+// GCC and clang support labels as values: each opcode then gets its own
+// indirect jump to a label where its handler is inlined, instead of an
+// indirect call through opcode_table. Define CPU_NO_COMPUTED_GOTO to force
+// the portable function pointer dispatch.
+#if defined(__GNUC__) && !defined(CPU_NO_COMPUTED_GOTO)
+#define CPU_COMPUTED_GOTO
+#define OPCODE_LABEL_ADDR(code, name, lg, dur) [code] = &&op_label_##code,
+#define OPCODE_LABEL(code, name, lg, dur)                                      \
+	op_label_##code : op_##name(gb, &op);                                  \
+	goto dispatched;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////
+// decoded instruction cache
+/////////////////////////////////////////////////////////////////////////////////////
+
+// Instructions are decoded once (handler, operands, length and duration) and
+// kept per address. ROM gets one table per bank, allocated the first time
+// code runs from it, and never has to be invalidated. WRAM and HRAM entries
+// are checked against the instruction bytes before use, so that memory
+// writes never have to care about them.
+// Code elsewhere (VRAM, cartridge RAM, OAM...) is decoded at each execution.
+
+static void cpu_decode_fill(struct gb *gb, struct cpu_decoded *d, uint16_t pc)
+{
+	uint8_t opcode = mem_get_byte(gb, pc);
+	const struct cpu_opcode *entry = &opcode_table[opcode];
+
+	d->handler = entry->handler;
+	d->opcode = opcode;
+	d->length = entry->length;
+	d->duration = entry->duration;
+
+	// Get the u16 value after opcode even if not needed.
+	d->u8 = mem_get_byte(gb, pc + 1);
+	d->u16 = mem_get_byte(gb, pc + 2) << 8 | d->u8;
+}
+
+// RAM may have been written since the entry was decoded
+static int cpu_decode_is_valid(struct gb *gb, const struct cpu_decoded *d,
+			       uint16_t pc)
+{
+	if (mem_get_byte(gb, pc) != d->opcode)
+		return 0;
+	if (d->length > 1 && mem_get_byte(gb, pc + 1) != d->u8)
+		return 0;
+	if (d->length > 2 && mem_get_byte(gb, pc + 2) != d->u16 >> 8)
+		return 0;
+	return 1;
+}
+
+static const struct cpu_decoded *cpu_decode(struct gb *gb, uint16_t pc)
+{
+	struct cpu_decoded *d = NULL;
+	uint16_t end; // first address after the cached range
+
+	// During OAM DMA the CPU reads 0xFF anywhere below 0xFF00, ROM
+	// included: what it decodes meanwhile must not outlive the transfer
+	if (gb->mem.DMA_active) {
+		cpu_decode_fill(gb, &gb->cpu.uncached, pc);
+		return &gb->cpu.uncached;
+	}
+
+	if (pc < 0x8000) {
+		uint16_t bank = mem_get_ROM_bank(gb, pc);
+
+		if (!gb->cpu.decode_ROM[bank])
+			gb->cpu.decode_ROM[bank] = calloc(BANK_SIZE_ROM,
+						  sizeof(struct cpu_decoded));
+		if (gb->cpu.decode_ROM[bank])
+			d = &gb->cpu.decode_ROM[bank][pc & (BANK_SIZE_ROM - 1)];
+		end = (pc & 0xC000) + BANK_SIZE_ROM;
+	} else if (pc >= CPU_WRAM_START && pc < CPU_WRAM_END) {
+		d = &gb->cpu.decode_WRAM[pc - CPU_WRAM_START];
+		end = CPU_WRAM_END;
+	} else if (pc >= CPU_HRAM_START && pc < CPU_HRAM_END) {
+		d = &gb->cpu.decode_HRAM[pc - CPU_HRAM_START];
+		end = CPU_HRAM_END;
+	}
+
+	if (!d) {
+		cpu_decode_fill(gb, &gb->cpu.uncached, pc);
+		return &gb->cpu.uncached;
+	}
+
+	if (d->length && (pc < 0x8000 || cpu_decode_is_valid(gb, d, pc)))
+		return d;
+
+	cpu_decode_fill(gb, d, pc);
+
+	// operands in another range could change without invalidating the entry
+	if ((uint32_t)pc + d->length > end) {
+		gb->cpu.uncached = *d;
+		d->length = 0;
+		return &gb->cpu.uncached;
+	}
+
+	return d;
+}
+
+// run a decoded instruction, returns its duration
+static uint8_t cpu_exec_decoded(struct gb *gb, const struct cpu_decoded *d)
+{
+	uint8_t length = d->length;
+	struct cpu_op op;
+
+	op.u8 = d->u8;
+	op.u16 = d->u16;
+	op.duration = d->duration;
+	op.add_lg = 1;
+#ifdef CPU_ACCESS_TIMING
+	// the opcode and its operands are fetched first
+	gb->cpu.cycles_access = length * 4;
+#endif
+
+	d->handler(gb, &op);
+
+	if (op.add_lg)
+		gb->cpu.regs.PC += length;
+	// the next instruction, even in the same block, sees the time of
+	// its own accesses
+	gb->cpu.cycles_run += op.duration;
+#ifdef CPU_ACCESS_TIMING
+	gb->cpu.cycles_access = 0;
+#endif
+
+	return op.duration;
+}
+
+uint8_t cpu_exec_opcode(struct gb *gb, uint8_t *opcode_length,
+			uint8_t *opcode_duration)
+{
+	const struct cpu_decoded *d = cpu_decode(gb, gb->cpu.regs.PC);
+	// the handler may overwrite its own entry
+	uint8_t length = d->length;
+	struct cpu_op op;
+
+	op.u8 = d->u8;
+	op.u16 = d->u16;
+	op.duration = d->duration;
+	op.add_lg = 1;
+#ifdef CPU_ACCESS_TIMING
+	gb->cpu.cycles_access = length * 4;
+#endif
+
+#ifdef CPU_COMPUTED_GOTO
+	static const void *const labels[0x100] = {
+		CPU_OPCODE_TABLE(OPCODE_LABEL_ADDR)
+	};
+
+	goto *labels[d->opcode];
+	CPU_OPCODE_TABLE(OPCODE_LABEL)
+dispatched:
+#else
+	d->handler(gb, &op);
+#endif
+
+	*opcode_length = length;
+	*opcode_duration = op.duration;
+
+	if (op.add_lg)
+		gb->cpu.regs.PC += length;
+	// the next instruction, even in the same block, sees the time of
+	// its own accesses
+	gb->cpu.cycles_run += op.duration;
+#ifdef CPU_ACCESS_TIMING
+	gb->cpu.cycles_access = 0;
+#endif
+
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// block cache
+/////////////////////////////////////////////////////////////////////////////////////
+
+// Basic blocks of ROM code executed often enough are translated once into
+// an array of decoded instructions, which is then run without looking up
+// the decoded instruction cache for each of them. The cache is keyed on PC and on
+// the ROM bank mapped at PC, ROM is never written so translations never have
+// to be invalidated. Code in RAM, code run during OAM DMA, and instructions
+// accessing I/O registers through an immediate address, are always run by
+// cpu_exec_opcode.
+// Define CPU_NO_BLOCK_CACHE to disable it.
+#define BLOCK_HOT 32 // executions of a PC before its block gets translated
+
+typedef enum {
+	BLOCK_EMPTY,
+	BLOCK_COUNTING,
+	BLOCK_TRANSLATED,
+	BLOCK_REJECTED, // first instruction can't be translated
+} cpu_block_state;
+
+typedef enum {
+	BLOCK_OP_PLAIN = 0,
+	BLOCK_OP_END, // changes PC or interrupt state, last op of a block
+	BLOCK_OP_REJECT, // never translated
+} cpu_block_op_kind;
+
+static const uint8_t block_op_kind[0x100] = {
+	// STOP, HALT
+	[0x10] = BLOCK_OP_REJECT, [0x76] = BLOCK_OP_REJECT,
+	// JR
+	[0x18] = BLOCK_OP_END, [0x20] = BLOCK_OP_END, [0x28] = BLOCK_OP_END,
+	[0x30] = BLOCK_OP_END, [0x38] = BLOCK_OP_END,
+	// RET, RETI
+	[0xC0] = BLOCK_OP_END, [0xC8] = BLOCK_OP_END, [0xC9] = BLOCK_OP_END,
+	[0xD0] = BLOCK_OP_END, [0xD8] = BLOCK_OP_END, [0xD9] = BLOCK_OP_END,
+	// JP
+	[0xC2] = BLOCK_OP_END, [0xC3] = BLOCK_OP_END, [0xCA] = BLOCK_OP_END,
+	[0xD2] = BLOCK_OP_END, [0xDA] = BLOCK_OP_END, [0xE9] = BLOCK_OP_END,
+	// CALL
+	[0xC4] = BLOCK_OP_END, [0xCC] = BLOCK_OP_END, [0xCD] = BLOCK_OP_END,
+	[0xD4] = BLOCK_OP_END, [0xDC] = BLOCK_OP_END,
+	// RST
+	[0xC7] = BLOCK_OP_END, [0xCF] = BLOCK_OP_END, [0xD7] = BLOCK_OP_END,
+	[0xDF] = BLOCK_OP_END, [0xE7] = BLOCK_OP_END, [0xEF] = BLOCK_OP_END,
+	[0xF7] = BLOCK_OP_END, [0xFF] = BLOCK_OP_END,
+	// DI, EI
+	[0xF3] = BLOCK_OP_END, [0xFB] = BLOCK_OP_END,
+	// LDH (a8),A, LDH A,(a8), LD (C),A, LD A,(C)
+	[0xE0] = BLOCK_OP_REJECT, [0xF0] = BLOCK_OP_REJECT,
+	[0xE2] = BLOCK_OP_REJECT, [0xF2] = BLOCK_OP_REJECT,
+	// illegal opcodes
+	[0xD3] = BLOCK_OP_REJECT, [0xDB] = BLOCK_OP_REJECT,
+	[0xDD] = BLOCK_OP_REJECT, [0xE3] = BLOCK_OP_REJECT,
+	[0xE4] = BLOCK_OP_REJECT, [0xEB] = BLOCK_OP_REJECT,
+	[0xEC] = BLOCK_OP_REJECT, [0xED] = BLOCK_OP_REJECT,
+	[0xF4] = BLOCK_OP_REJECT, [0xFC] = BLOCK_OP_REJECT,
+	[0xFD] = BLOCK_OP_REJECT,
+};
+
+static void cpu_block_translate(struct gb *gb, struct cpu_block *block)
+{
+	uint16_t pc = block->key & 0xFFFF;
+	uint16_t region = pc & 0xC000;
+
+	block->count = 0;
+
+	while (block->count < BLOCK_MAX_OPS) {
+		const struct cpu_decoded *d = cpu_decode(gb, pc);
+		uint8_t kind = block_op_kind[d->opcode];
+
+		// stay in the same 16 kB ROM region, the next one may be banked
+		if (((pc + d->length - 1) & 0xC000) != region)
+			break;
+
+		// absolute accesses to I/O registers or to the MBC
+		if (d->opcode == 0xEA || d->opcode == 0xFA) {
+			if (d->u16 >= 0xFF00)
+				kind = BLOCK_OP_REJECT;
+			else if (d->u16 < 0x8000)
+				kind = BLOCK_OP_END;
+		}
+
+		if (kind == BLOCK_OP_REJECT)
+			break;
+
+		block->ops[block->count++] = *d;
+		pc += d->length;
+
+		if (kind == BLOCK_OP_END)
+			break;
+	}
+
+	block->state = block->count ? BLOCK_TRANSLATED : BLOCK_REJECTED;
+}
+
+static void cpu_block_run(struct gb *gb, const struct cpu_block *block,
+			  uint8_t *op_count, uint16_t *block_duration)
+{
+	// code in the switchable ROM bank has to stop if it switches the bank,
+	// any code if it starts an OAM DMA, which hides the ROM, and the block
+	// does not run past the budget of cpu_run(), the next event is due
+	uint16_t bank = block->key >> 16;
+	uint16_t duration = 0;
+	int i;
+
+	for (i = 0; i < block->count; i++) {
+		duration += cpu_exec_decoded(gb, &block->ops[i]);
+
+		if (gb->cpu.cycles_run >= gb->cpu.cycle_budget ||
+		    gb->mem.DMA_active ||
+		    (bank && mem_get_ROM_bank(gb, gb->cpu.regs.PC) != bank)) {
+			i++;
+			break;
+		}
+	}
+
+	*op_count = i;
+	*block_duration = duration;
+}
+
+void cpu_cache_flush(struct gb *gb)
+{
+	int i;
+
+	for (i = 0; i < CPU_ROM_BANK_MAX; i++) {
+		free(gb->cpu.decode_ROM[i]);
+		gb->cpu.decode_ROM[i] = NULL;
+	}
+	memset(gb->cpu.decode_WRAM, 0, sizeof(gb->cpu.decode_WRAM));
+	memset(gb->cpu.decode_HRAM, 0, sizeof(gb->cpu.decode_HRAM));
+	memset(gb->cpu.block_cache, 0, sizeof(gb->cpu.block_cache));
+}
+
+uint8_t cpu_exec_block(struct gb *gb, uint8_t *op_count,
+		       uint16_t *block_duration)
+{
+	uint8_t length, duration;
+
+#ifndef CPU_NO_BLOCK_CACHE
+	if (gb->cpu.regs.PC < 0x8000 && !gb->mem.DMA_active) {
+		uint32_t key = mem_get_ROM_bank(gb, gb->cpu.regs.PC) << 16 |
+			       gb->cpu.regs.PC;
+		struct cpu_block *block =
+			&gb->cpu.block_cache[(gb->cpu.regs.PC ^ (key >> 9)) &
+				     (BLOCK_CACHE_SIZE - 1)];
+
+		if (block->state == BLOCK_EMPTY || block->key != key) {
+			block->key = key;
+			block->state = BLOCK_COUNTING;
+			block->hits = 0;
+		}
+
+		if (block->state == BLOCK_COUNTING && ++block->hits >= BLOCK_HOT)
+			cpu_block_translate(gb, block);
+
+		if (block->state == BLOCK_TRANSLATED) {
+			cpu_block_run(gb, block, op_count, block_duration);
+			return 0;
+		}
+	}
+#endif
+
+	cpu_exec_opcode(gb, &length, &duration);
+	*op_count = 1;
+	*block_duration = duration;
+
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// idle loops
+/////////////////////////////////////////////////////////////////////////////////////
+
+// Games often wait for a scanline, a GPU mode or an input with loops like
+//	LDH A,(44h) ; CP n ; JR NZ,-6
+// Every iteration reads the same value and leaves A and the flags in the same
+// state, until the register changes, which can only happen at a hardware
+// event (or on an host input). All iterations before that event are run at
+// once.
+static int cpu_idle_loop_register(uint16_t addr)
+{
+	switch (addr) {
+	case P1:
+	case IF:
+	case STAT:
+	case LY:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t cpu_skip_idle_loop(struct gb *gb, uint32_t cycles_to_event)
+{
+	struct cpu_decoded read, test, jump;
+	uint16_t pc = gb->cpu.regs.PC;
+	uint32_t duration, elapsed, iterations;
+
+	// LDH A,(a8) or LD A,(a16)
+	read = *cpu_decode(gb, pc);
+	if (read.opcode == 0xF0) {
+		if (!cpu_idle_loop_register(0xFF00 + read.u8))
+			return 0;
+	} else if (read.opcode != 0xFA || !cpu_idle_loop_register(read.u16)) {
+		return 0;
+	}
+
+	// CP d8, AND d8 or BIT b,A
+	test = *cpu_decode(gb, pc + read.length);
+	if (test.opcode != 0xFE && test.opcode != 0xE6 &&
+	    (test.opcode != 0xCB || (test.u8 & 0xC7) != 0x47))
+		return 0;
+
+	// JR NZ or JR Z back to the read
+	jump = *cpu_decode(gb, pc + read.length + test.length);
+	if ((jump.opcode != 0x20 && jump.opcode != 0x28) ||
+	    (int8_t)jump.u8 != -(read.length + test.length + jump.length))
+		return 0;
+
+	// the jump is taken, 4 cycles longer than in the table
+	duration = read.duration + test.duration + jump.duration + 4;
+	if (duration >= cycles_to_event)
+		return 0;
+
+	// Run a first iteration: if the loop is not left, the next ones would
+	// leave the CPU in the exact same state
+	elapsed = cpu_exec_decoded(gb, &read);
+	elapsed += cpu_exec_decoded(gb, &test);
+	elapsed += cpu_exec_decoded(gb, &jump);
+	if (gb->cpu.regs.PC != pc)
+		return elapsed;
+
+	iterations = (cycles_to_event - 1) / duration;
+
+	return iterations * duration;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// run loop
+/////////////////////////////////////////////////////////////////////////////////////
+
+#define INT_DISPATCH_DURATION 20 // cycles to push PC and jump to the handler
+
+// Jump to the highest priority pending interrupt, returns the duration of
+// the dispatch
+static uint8_t cpu_handle_interrupts(struct gb *gb)
+{
+	static const uint16_t int_addr[5] = {
+		INT_VBLANK_ADDR, INT_LCDC_ADDR, INT_TIMER_ADDR,
+		INT_SERIAL_ADDR, INT_JOYPAD_ADDR,
+	};
+	uint8_t val_IF = mem_get_byte(gb, IF);
+	uint8_t pending = mem_get_byte(gb, IE) & val_IF & 0x1F;
+	int i;
+
+	// A halted CPU wakes up on any pending interrupt, even with
+	// interrupts disabled, a stopped one on a joypad input
+	if (gb->cpu.run_state == CPU_HALTED && pending)
+		gb->cpu.run_state = CPU_RUNNING;
+	else if (gb->cpu.run_state == CPU_STOPPED && (val_IF & INT_JOYPAD))
+		gb->cpu.run_state = CPU_RUNNING;
+
+	if (!gb->cpu.interrupts_enabled || !pending)
+		return 0;
+
+	for (i = 0; !(pending & (1 << i)); i++)
+		;
+
+	mem_set_byte(gb, IF, val_IF & ~(1 << i));
+	gb->cpu.interrupts_enabled = 0;
+	SP_push(gb, gb->cpu.regs.PC);
+	gb->cpu.regs.PC = int_addr[i];
+
+	return INT_DISPATCH_DURATION;
+}
+
+// Run instructions until at least cycle_budget clock cycles have elapsed,
+// returns the number of cycles actually run. The caller is expected to
+// update the peripherals afterwards, so the budget should not go past
+// their next event; an event scheduled during the run shortens it through
+// cpu_limit_run(). A stopped CPU returns early, a halted one consumes
+// the whole budget at once.
+uint32_t cpu_run(struct gb *gb, uint32_t cycle_budget)
+{
+	uint32_t cycles = 0;
+	uint32_t duration;
+	uint16_t block_duration;
+	uint8_t op_count;
+
+	gb->cpu.cycle_budget = cycle_budget;
+
+	while (cycles < gb->cpu.cycle_budget) {
+		duration = cpu_handle_interrupts(gb);
+
+		if (gb->cpu.run_state == CPU_STOPPED)
+			break;
+
+		// an interrupt dispatch is an iteration by itself, the budget
+		// may be over once it is done
+		if (!duration && gb->cpu.run_state == CPU_HALTED) {
+			duration = gb->cpu.cycle_budget - cycles;
+		} else if (!duration) {
+			duration = cpu_skip_idle_loop(gb,
+					gb->cpu.cycle_budget - cycles);
+			if (!duration) {
+				cpu_exec_block(gb, &op_count, &block_duration);
+				duration = block_duration;
+			}
 		}
+
+		cycles += duration;
+		gb->cpu.cycles_run = cycles;
 	}
+
+	// from now on accounted by the scheduler
+	gb->cpu.cycles_run = 0;
+	gb->cpu.cycles_access = 0;
+	gb->cpu.cycle_budget = 0;
+	return cycles;
+}
+
+// Cycles already run in the current cpu_run(), for the peripherals computing
+// their state from the time of the access: up to the current instruction, or
+// up to the current memory access with CPU_ACCESS_TIMING
+uint32_t cpu_get_cycles_run(struct gb *gb)
+{
+	return gb->cpu.cycles_run + gb->cpu.cycles_access;
+}
+
+// An event is due cycles after the start of the current cpu_run(): the run
+// stops there, even if these cycles are already run. Nothing to do outside
+// of a run, whose budget is 0.
+void cpu_limit_run(struct gb *gb, uint32_t cycles)
+{
+	if (cycles < gb->cpu.cycle_budget)
+		gb->cpu.cycle_budget = cycles;
+}
+
+void cpu_init(struct gb *gb)
+{
+	cpu_set_AF(gb, 0x01);
+	cpu_set_F(gb, 0xB0);
+	cpu_set_BC(gb, 0x0013);
+	cpu_set_DE(gb, 0x00D8);
+	cpu_set_HL(gb, 0x014D);
+	cpu_set_SP(gb, 0xFFFE);
+	cpu_set_PC(gb, 0x0100);
+	gb->cpu.interrupts_enabled = 1;
+	gb->cpu.run_state = CPU_RUNNING;
+	cpu_cache_flush(gb);
 }
 
-void cpu_init()
+void cpu_release(struct gb *gb)
 {
-	cpu_set_AF(0x01);
-	cpu_set_F(0xB0);
-	cpu_set_BC(0x0013);
-	cpu_set_DE(0x00D8);
-	cpu_set_HL(0x014D);
-	cpu_set_SP(0xFFFE);
-	cpu_set_PC(0x0100);
+	cpu_cache_flush(gb);
 }
\ No newline at end of file
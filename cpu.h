@@ -7,6 +7,8 @@
 #include <inttypes.h>
 
 
+#define CPU_FREQ            4194304 // clock cycles per second
+
 #define INT_VBLANK          0x01
 #define INT_VBLANK_ADDR     0x40
 #define INT_LCDC            0x02
@@ -25,59 +27,147 @@ typedef enum {
     FLAG_CARRY,
 } cpu_flag_name;
 
+typedef enum {
+    CPU_RUNNING,
+    CPU_HALTED,     // until an interrupt is pending
+    CPU_STOPPED,    // until a joypad input
+} cpu_state;
+
 typedef enum {
     FALSE = 0,
     TRUE = 1,
 } cpu_flag_value;
 
-
-void cpu_reset_registers();
-
-
-uint8_t cpu_get_A();
-uint8_t cpu_get_B();
-uint8_t cpu_get_C();
-uint8_t cpu_get_D();
-uint8_t cpu_get_E();
-uint8_t cpu_get_F();
-uint8_t cpu_get_H();
-uint8_t cpu_get_L();
-
-uint16_t cpu_get_AF();
-uint16_t cpu_get_BC();
-uint16_t cpu_get_DE();
-uint16_t cpu_get_HL();
-
-uint16_t cpu_get_SP();
-uint16_t cpu_get_PC();
-
-void cpu_set_A(uint8_t value);
-void cpu_set_B(uint8_t value);
-void cpu_set_C(uint8_t value);
-void cpu_set_D(uint8_t value);
-void cpu_set_E(uint8_t value);
-void cpu_set_F(uint8_t value);
-void cpu_set_H(uint8_t value);
-void cpu_set_L(uint8_t value);
-
-void cpu_set_AF(uint16_t value);
-void cpu_set_BC(uint16_t value);
-void cpu_set_DE(uint16_t value);
-void cpu_set_HL(uint16_t value);
-
-void cpu_set_SP(uint16_t value);
-void cpu_set_PC(uint16_t value);
-
-void SP_push(uint16_t val);
-
-uint8_t cpu_exec_opcode(uint8_t *opcode_length, uint8_t *opcode_duration);
-
-cpu_flag_value cpu_get_flag(cpu_flag_name flag);
-int cpu_set_flag(cpu_flag_name flag, cpu_flag_value value);
-
-uint8_t cpu_get_interrupts_enabled();
-void cpu_set_interrupts_enabled(uint8_t val);
-
-void cpu_init();
+struct gb;
+struct cpu_op;
+
+struct cpu_registers {
+    uint8_t A;
+    uint8_t F;
+    uint8_t B;
+    uint8_t C;
+    uint8_t D;
+    uint8_t E;
+    uint8_t H;
+    uint8_t L;
+    uint16_t SP; // stack pointer
+    uint16_t PC; // program counter
+};
+
+// last flag-setting operation, whose flags are not computed yet
+struct cpu_lazy_flags {
+    uint8_t mask;   // bits of F still to be computed from the fields below
+    uint8_t op;     // operation which produced them
+    uint16_t a;     // first operand
+    uint16_t b;     // second operand
+    uint8_t carry;  // carry in of ADC and SBC
+    uint8_t res;    // 8 bits result
+};
+
+// decoded instruction
+struct cpu_decoded {
+    void (*handler)(struct gb *gb, struct cpu_op *op);
+    uint16_t u16;
+    uint8_t u8;
+    uint8_t opcode;
+    uint8_t length;     // 0 if the entry has not been decoded
+    uint8_t duration;
+};
+
+#define CPU_ROM_BANK_MAX    0x200
+#define CPU_WRAM_START      0xC000
+#define CPU_WRAM_END        0xE000
+#define CPU_HRAM_START      0xFF80
+#define CPU_HRAM_END        0xFFFF
+
+#define BLOCK_CACHE_SIZE    2048    // must be a power of 2
+#define BLOCK_MAX_OPS       16
+
+struct cpu_block {
+    uint32_t key;   // ROM bank << 16 | PC
+    uint8_t state;
+    uint8_t hits;
+    uint8_t count;
+    struct cpu_decoded ops[BLOCK_MAX_OPS];
+};
+
+struct cpu_context {
+    struct cpu_registers regs;
+    struct cpu_lazy_flags flags;
+    uint8_t interrupts_enabled;
+    cpu_state run_state;
+    uint32_t cycles_run;    // in the current cpu_run(), not yet scheduled
+    uint32_t cycle_budget;  // of the current cpu_run(), up to the next event
+    uint32_t cycles_access; // of the current instruction, up to its next access
+
+    // decoded instructions: one table per ROM bank, allocated on first use
+    struct cpu_decoded *decode_ROM[CPU_ROM_BANK_MAX];
+    struct cpu_decoded decode_WRAM[CPU_WRAM_END - CPU_WRAM_START];
+    struct cpu_decoded decode_HRAM[CPU_HRAM_END - CPU_HRAM_START];
+    struct cpu_decoded uncached;
+
+    struct cpu_block block_cache[BLOCK_CACHE_SIZE];
+};
+
+
+void cpu_reset_registers(struct gb *gb);
+
+
+uint8_t cpu_get_A(struct gb *gb);
+uint8_t cpu_get_B(struct gb *gb);
+uint8_t cpu_get_C(struct gb *gb);
+uint8_t cpu_get_D(struct gb *gb);
+uint8_t cpu_get_E(struct gb *gb);
+uint8_t cpu_get_F(struct gb *gb);
+uint8_t cpu_get_H(struct gb *gb);
+uint8_t cpu_get_L(struct gb *gb);
+
+uint16_t cpu_get_AF(struct gb *gb);
+uint16_t cpu_get_BC(struct gb *gb);
+uint16_t cpu_get_DE(struct gb *gb);
+uint16_t cpu_get_HL(struct gb *gb);
+
+uint16_t cpu_get_SP(struct gb *gb);
+uint16_t cpu_get_PC(struct gb *gb);
+
+void cpu_set_A(struct gb *gb, uint8_t value);
+void cpu_set_B(struct gb *gb, uint8_t value);
+void cpu_set_C(struct gb *gb, uint8_t value);
+void cpu_set_D(struct gb *gb, uint8_t value);
+void cpu_set_E(struct gb *gb, uint8_t value);
+void cpu_set_F(struct gb *gb, uint8_t value);
+void cpu_set_H(struct gb *gb, uint8_t value);
+void cpu_set_L(struct gb *gb, uint8_t value);
+
+void cpu_set_AF(struct gb *gb, uint16_t value);
+void cpu_set_BC(struct gb *gb, uint16_t value);
+void cpu_set_DE(struct gb *gb, uint16_t value);
+void cpu_set_HL(struct gb *gb, uint16_t value);
+
+void cpu_set_SP(struct gb *gb, uint16_t value);
+void cpu_set_PC(struct gb *gb, uint16_t value);
+
+void SP_push(struct gb *gb, uint16_t val);
+
+uint8_t cpu_exec_opcode(struct gb *gb, uint8_t *opcode_length,
+                        uint8_t *opcode_duration);
+uint8_t cpu_exec_block(struct gb *gb, uint8_t *op_count,
+                       uint16_t *block_duration);
+uint32_t cpu_run(struct gb *gb, uint32_t cycle_budget);
+uint32_t cpu_get_cycles_run(struct gb *gb);
+void cpu_limit_run(struct gb *gb, uint32_t cycles);
+void cpu_cache_flush(struct gb *gb);
+
+cpu_flag_value cpu_get_flag(struct gb *gb, cpu_flag_name flag);
+int cpu_set_flag(struct gb *gb, cpu_flag_name flag, cpu_flag_value value);
+
+uint8_t cpu_get_interrupts_enabled(struct gb *gb);
+void cpu_set_interrupts_enabled(struct gb *gb, uint8_t val);
+
+cpu_state cpu_get_state(struct gb *gb);
+void cpu_set_state(struct gb *gb, cpu_state state);
+
+void cpu_init(struct gb *gb);
+void cpu_release(struct gb *gb);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,273 @@
+#ifndef CPU_OPCODES_H
+#define CPU_OPCODES_H
+
+/*
+ * Opcode table of the CPU, expanded by cpu.c into the handler table and,
+ * when the compiler supports it, into the computed goto labels.
+ *
+ * X(opcode, handler, length in byte, duration in clock cycles)
+ *
+ * This is the only timing reference of the emulator. For conditional jumps,
+ * calls and returns the duration is the one of the branch not taken, the
+ * handler raises it when the branch is taken. CB prefixed instructions last
+ * 8 cycles, the handler raises it for (HL) operands.
+ */
+#define CPU_OPCODE_TABLE(X)						\
+	X(0x00, NOP, 1, 4)						\
+	X(0x01, LD_BC_d16, 3, 12)					\
+	X(0x02, LD_mBC_A, 1, 8)						\
+	X(0x03, INC_BC, 1, 8)						\
+	X(0x04, INC_B, 1, 4)						\
+	X(0x05, DEC_B, 1, 4)						\
+	X(0x06, LD_B_d8, 2, 8)						\
+	X(0x07, RLC_A, 1, 4)						\
+	X(0x08, LD_ma16_SP, 3, 20)					\
+	X(0x09, ADD_HL_BC, 1, 8)					\
+	X(0x0A, LD_A_mBC, 1, 8)						\
+	X(0x0B, DEC_BC, 1, 8)						\
+	X(0x0C, INC_C, 1, 4)						\
+	X(0x0D, DEC_C, 1, 4)						\
+	X(0x0E, LD_C_d8, 2, 8)						\
+	X(0x0F, RRC_A, 1, 4)						\
+	X(0x10, STOP, 2, 4)						\
+	X(0x11, LD_DE_d16, 3, 12)					\
+	X(0x12, LD_mDE_A, 1, 8)						\
+	X(0x13, INC_DE, 1, 8)						\
+	X(0x14, INC_D, 1, 4)						\
+	X(0x15, DEC_D, 1, 4)						\
+	X(0x16, LD_D_d8, 2, 8)						\
+	X(0x17, RL_A, 1, 4)						\
+	X(0x18, JR_r8, 2, 12)						\
+	X(0x19, ADD_HL_DE, 1, 8)					\
+	X(0x1A, LD_A_mDE, 1, 8)						\
+	X(0x1B, DEC_DE, 1, 8)						\
+	X(0x1C, INC_E, 1, 4)						\
+	X(0x1D, DEC_E, 1, 4)						\
+	X(0x1E, LD_E_d8, 2, 8)						\
+	X(0x1F, RR_A, 1, 4)						\
+	X(0x20, JR_NZ_r8, 2, 8)						\
+	X(0x21, LD_HL_d16, 3, 12)					\
+	X(0x22, LD_mHLI_A, 1, 8)					\
+	X(0x23, INC_HL, 1, 8)						\
+	X(0x24, INC_H, 1, 4)						\
+	X(0x25, DEC_H, 1, 4)						\
+	X(0x26, LD_H_d8, 2, 8)						\
+	X(0x27, DAA, 1, 4)						\
+	X(0x28, JR_Z_r8, 2, 8)						\
+	X(0x29, ADD_HL_HL, 1, 8)					\
+	X(0x2A, LD_A_mHLI, 1, 8)					\
+	X(0x2B, DEC_HL, 1, 8)						\
+	X(0x2C, INC_L, 1, 4)						\
+	X(0x2D, DEC_L, 1, 4)						\
+	X(0x2E, LD_L_d8, 2, 8)						\
+	X(0x2F, CPL, 1, 4)						\
+	X(0x30, JR_NC_r8, 2, 8)						\
+	X(0x31, LD_SP_d16, 3, 12)					\
+	X(0x32, LD_mHLD_A, 1, 8)					\
+	X(0x33, INC_SP, 1, 8)						\
+	X(0x34, INC_mHL, 1, 12)						\
+	X(0x35, DEC_mHL, 1, 12)						\
+	X(0x36, LD_mHL_d8, 2, 12)					\
+	X(0x37, SCF, 1, 4)						\
+	X(0x38, JR_C_r8, 2, 8)						\
+	X(0x39, ADD_HL_SP, 1, 8)					\
+	X(0x3A, LD_A_mHLD, 1, 8)					\
+	X(0x3B, DEC_SP, 1, 8)						\
+	X(0x3C, INC_A, 1, 4)						\
+	X(0x3D, DEC_A, 1, 4)						\
+	X(0x3E, LD_A_d8, 2, 8)						\
+	X(0x3F, CCF, 1, 4)						\
+	X(0x40, LD_B_B, 1, 4)						\
+	X(0x41, LD_B_C, 1, 4)						\
+	X(0x42, LD_B_D, 1, 4)						\
+	X(0x43, LD_B_E, 1, 4)						\
+	X(0x44, LD_B_H, 1, 4)						\
+	X(0x45, LD_B_L, 1, 4)						\
+	X(0x46, LD_B_mHL, 1, 8)						\
+	X(0x47, LD_B_A, 1, 4)						\
+	X(0x48, LD_C_B, 1, 4)						\
+	X(0x49, LD_C_C, 1, 4)						\
+	X(0x4A, LD_C_D, 1, 4)						\
+	X(0x4B, LD_C_E, 1, 4)						\
+	X(0x4C, LD_C_H, 1, 4)						\
+	X(0x4D, LD_C_L, 1, 4)						\
+	X(0x4E, LD_C_mHL, 1, 8)						\
+	X(0x4F, LD_C_A, 1, 4)						\
+	X(0x50, LD_D_B, 1, 4)						\
+	X(0x51, LD_D_C, 1, 4)						\
+	X(0x52, LD_D_D, 1, 4)						\
+	X(0x53, LD_D_E, 1, 4)						\
+	X(0x54, LD_D_H, 1, 4)						\
+	X(0x55, LD_D_L, 1, 4)						\
+	X(0x56, LD_D_mHL, 1, 8)						\
+	X(0x57, LD_D_A, 1, 4)						\
+	X(0x58, LD_E_B, 1, 4)						\
+	X(0x59, LD_E_C, 1, 4)						\
+	X(0x5A, LD_E_D, 1, 4)						\
+	X(0x5B, LD_E_E, 1, 4)						\
+	X(0x5C, LD_E_H, 1, 4)						\
+	X(0x5D, LD_E_L, 1, 4)						\
+	X(0x5E, LD_E_mHL, 1, 8)						\
+	X(0x5F, LD_E_A, 1, 4)						\
+	X(0x60, LD_H_B, 1, 4)						\
+	X(0x61, LD_H_C, 1, 4)						\
+	X(0x62, LD_H_D, 1, 4)						\
+	X(0x63, LD_H_E, 1, 4)						\
+	X(0x64, LD_H_H, 1, 4)						\
+	X(0x65, LD_H_L, 1, 4)						\
+	X(0x66, LD_H_mHL, 1, 8)						\
+	X(0x67, LD_H_A, 1, 4)						\
+	X(0x68, LD_L_B, 1, 4)						\
+	X(0x69, LD_L_C, 1, 4)						\
+	X(0x6A, LD_L_D, 1, 4)						\
+	X(0x6B, LD_L_E, 1, 4)						\
+	X(0x6C, LD_L_H, 1, 4)						\
+	X(0x6D, LD_L_L, 1, 4)						\
+	X(0x6E, LD_L_mHL, 1, 8)						\
+	X(0x6F, LD_L_A, 1, 4)						\
+	X(0x70, LD_mHL_B, 1, 8)						\
+	X(0x71, LD_mHL_C, 1, 8)						\
+	X(0x72, LD_mHL_D, 1, 8)						\
+	X(0x73, LD_mHL_E, 1, 8)						\
+	X(0x74, LD_mHL_H, 1, 8)						\
+	X(0x75, LD_mHL_L, 1, 8)						\
+	X(0x76, HALT, 1, 4)						\
+	X(0x77, LD_mHL_A, 1, 8)						\
+	X(0x78, LD_A_B, 1, 4)						\
+	X(0x79, LD_A_C, 1, 4)						\
+	X(0x7A, LD_A_D, 1, 4)						\
+	X(0x7B, LD_A_E, 1, 4)						\
+	X(0x7C, LD_A_H, 1, 4)						\
+	X(0x7D, LD_A_L, 1, 4)						\
+	X(0x7E, LD_A_mHL, 1, 8)						\
+	X(0x7F, LD_A_A, 1, 4)						\
+	X(0x80, ADD_A_B, 1, 4)						\
+	X(0x81, ADD_A_C, 1, 4)						\
+	X(0x82, ADD_A_D, 1, 4)						\
+	X(0x83, ADD_A_E, 1, 4)						\
+	X(0x84, ADD_A_H, 1, 4)						\
+	X(0x85, ADD_A_L, 1, 4)						\
+	X(0x86, ADD_A_mHL, 1, 8)					\
+	X(0x87, ADD_A_A, 1, 4)						\
+	X(0x88, ADC_A_B, 1, 4)						\
+	X(0x89, ADC_A_C, 1, 4)						\
+	X(0x8A, ADC_A_D, 1, 4)						\
+	X(0x8B, ADC_A_E, 1, 4)						\
+	X(0x8C, ADC_A_H, 1, 4)						\
+	X(0x8D, ADC_A_L, 1, 4)						\
+	X(0x8E, ADC_A_mHL, 1, 8)					\
+	X(0x8F, ADC_A_A, 1, 4)						\
+	X(0x90, SUB_A_B, 1, 4)						\
+	X(0x91, SUB_A_C, 1, 4)						\
+	X(0x92, SUB_A_D, 1, 4)						\
+	X(0x93, SUB_A_E, 1, 4)						\
+	X(0x94, SUB_A_H, 1, 4)						\
+	X(0x95, SUB_A_L, 1, 4)						\
+	X(0x96, SUB_A_mHL, 1, 8)					\
+	X(0x97, SUB_A_A, 1, 4)						\
+	X(0x98, SBC_A_B, 1, 4)						\
+	X(0x99, SBC_A_C, 1, 4)						\
+	X(0x9A, SBC_A_D, 1, 4)						\
+	X(0x9B, SBC_A_E, 1, 4)						\
+	X(0x9C, SBC_A_H, 1, 4)						\
+	X(0x9D, SBC_A_L, 1, 4)						\
+	X(0x9E, SBC_A_mHL, 1, 8)					\
+	X(0x9F, SBC_A_A, 1, 4)						\
+	X(0xA0, AND_A_B, 1, 4)						\
+	X(0xA1, AND_A_C, 1, 4)						\
+	X(0xA2, AND_A_D, 1, 4)						\
+	X(0xA3, AND_A_E, 1, 4)						\
+	X(0xA4, AND_A_H, 1, 4)						\
+	X(0xA5, AND_A_L, 1, 4)						\
+	X(0xA6, AND_A_mHL, 1, 8)					\
+	X(0xA7, AND_A_A, 1, 4)						\
+	X(0xA8, XOR_A_B, 1, 4)						\
+	X(0xA9, XOR_A_C, 1, 4)						\
+	X(0xAA, XOR_A_D, 1, 4)						\
+	X(0xAB, XOR_A_E, 1, 4)						\
+	X(0xAC, XOR_A_H, 1, 4)						\
+	X(0xAD, XOR_A_L, 1, 4)						\
+	X(0xAE, XOR_A_mHL, 1, 8)					\
+	X(0xAF, XOR_A_A, 1, 4)						\
+	X(0xB0, OR_A_B, 1, 4)						\
+	X(0xB1, OR_A_C, 1, 4)						\
+	X(0xB2, OR_A_D, 1, 4)						\
+	X(0xB3, OR_A_E, 1, 4)						\
+	X(0xB4, OR_A_H, 1, 4)						\
+	X(0xB5, OR_A_L, 1, 4)						\
+	X(0xB6, OR_A_mHL, 1, 8)						\
+	X(0xB7, OR_A_A, 1, 4)						\
+	X(0xB8, CP_A_B, 1, 4)						\
+	X(0xB9, CP_A_C, 1, 4)						\
+	X(0xBA, CP_A_D, 1, 4)						\
+	X(0xBB, CP_A_E, 1, 4)						\
+	X(0xBC, CP_A_H, 1, 4)						\
+	X(0xBD, CP_A_L, 1, 4)						\
+	X(0xBE, CP_A_mHL, 1, 8)						\
+	X(0xBF, CP_A_A, 1, 4)						\
+	X(0xC0, RET_NZ, 1, 8)						\
+	X(0xC1, POP_BC, 1, 12)						\
+	X(0xC2, JP_NZ_a16, 3, 12)					\
+	X(0xC3, JP_a16, 3, 16)						\
+	X(0xC4, CALL_NZ_a16, 3, 12)					\
+	X(0xC5, PUSH_BC, 1, 16)						\
+	X(0xC6, ADD_A_d8, 2, 8)						\
+	X(0xC7, RST_00H, 1, 16)						\
+	X(0xC8, RET_Z, 1, 8)						\
+	X(0xC9, RET, 1, 16)						\
+	X(0xCA, JP_Z_a16, 3, 12)					\
+	X(0xCB, PREFIX_CB, 2, 8)					\
+	X(0xCC, CALL_Z_a16, 3, 12)					\
+	X(0xCD, CALL_a16, 3, 24)					\
+	X(0xCE, ADC_A_d8, 2, 8)						\
+	X(0xCF, RST_08H, 1, 16)						\
+	X(0xD0, RET_NC, 1, 8)						\
+	X(0xD1, POP_DE, 1, 12)						\
+	X(0xD2, JP_NC_a16, 3, 12)					\
+	X(0xD3, ILLEGAL, 1, 4)						\
+	X(0xD4, CALL_NC_a16, 3, 12)					\
+	X(0xD5, PUSH_DE, 1, 16)						\
+	X(0xD6, SUB_A_d8, 2, 8)						\
+	X(0xD7, RST_10H, 1, 16)						\
+	X(0xD8, RET_C, 1, 8)						\
+	X(0xD9, RETI, 1, 16)						\
+	X(0xDA, JP_C_a16, 3, 12)					\
+	X(0xDB, ILLEGAL, 1, 4)						\
+	X(0xDC, CALL_C_a16, 3, 12)					\
+	X(0xDD, ILLEGAL, 1, 4)						\
+	X(0xDE, SBC_A_d8, 2, 8)						\
+	X(0xDF, RST_18H, 1, 16)						\
+	X(0xE0, LDH_ma8_A, 2, 12)					\
+	X(0xE1, POP_HL, 1, 12)						\
+	X(0xE2, LD_mC_A, 1, 8)						\
+	X(0xE3, ILLEGAL, 1, 4)						\
+	X(0xE4, ILLEGAL, 1, 4)						\
+	X(0xE5, PUSH_HL, 1, 16)						\
+	X(0xE6, AND_d8, 2, 8)						\
+	X(0xE7, RST_20H, 1, 16)						\
+	X(0xE8, ADD_SP_r8, 2, 16)					\
+	X(0xE9, JP_mHL, 1, 4)						\
+	X(0xEA, LD_ma16_A, 3, 16)					\
+	X(0xEB, ILLEGAL, 1, 4)						\
+	X(0xEC, ILLEGAL, 1, 4)						\
+	X(0xED, ILLEGAL, 1, 4)						\
+	X(0xEE, XOR_d8, 2, 8)						\
+	X(0xEF, RST_28H, 1, 16)						\
+	X(0xF0, LDH_A_ma8, 2, 12)					\
+	X(0xF1, POP_AF, 1, 12)						\
+	X(0xF2, LD_A_mC, 1, 8)						\
+	X(0xF3, DI, 1, 4)						\
+	X(0xF4, ILLEGAL, 1, 4)						\
+	X(0xF5, PUSH_AF, 1, 16)						\
+	X(0xF6, OR_d8, 2, 8)						\
+	X(0xF7, RST_30H, 1, 16)						\
+	X(0xF8, LD_HL_SP_r8, 2, 12)					\
+	X(0xF9, LD_SP_HL, 1, 8)						\
+	X(0xFA, LD_A_ma16, 3, 16)					\
+	X(0xFB, EI, 1, 4)						\
+	X(0xFC, ILLEGAL, 1, 4)						\
+	X(0xFD, ILLEGAL, 1, 4)						\
+	X(0xFE, CP_d8, 2, 8)						\
+	X(0xFF, RST_38H, 1, 16)
+
+#endif
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gb.h"
+
+struct gb *gb_create()
+{
+	struct gb *gb = calloc(1, sizeof(*gb));
+
+	if (!gb) {
+		printf("[gb.c] failed to allocate the console state\n");
+		return NULL;
+	}
+
+	mem_set_save_interval(gb, MEM_SAVE_INTERVAL_DEFAULT);
+
+	return gb;
+}
+
+// Power on, once the ROM is loaded
+void gb_init(struct gb *gb)
+{
+	sched_init(gb);
+	gpu_init(gb);
+	cpu_init(gb);
+	input_init(gb);
+	mem_init(gb);
+	time_init(gb);
+	timer_init(gb);
+}
+
+// Back to a blank console ready to load another ROM, only the display and save
+// settings are kept
+void gb_reset(struct gb *gb)
+{
+	SDL_Window *window = gb->gpu.window;
+	SDL_Renderer *renderer = gb->gpu.renderer;
+	SDL_Texture *texture = gb->gpu.texture;
+	uint8_t scale = gb->gpu.scale;
+	uint8_t headless = gb->gpu.headless;
+	int32_t save_interval = gb->mem.save_interval;
+
+	cpu_release(gb);
+	mem_release(gb);
+	memset(gb, 0, sizeof(*gb));
+
+	gb->gpu.window = window;
+	gb->gpu.renderer = renderer;
+	gb->gpu.texture = texture;
+	gb->gpu.scale = scale;
+	gb->gpu.headless = headless;
+	gb->mem.save_interval = save_interval;
+}
+
+void gb_destroy(struct gb *gb)
+{
+	if (!gb)
+		return;
+
+	cpu_release(gb);
+	mem_release(gb);
+
+	if (gb->gpu.texture)
+		SDL_DestroyTexture(gb->gpu.texture);
+	if (gb->gpu.renderer)
+		SDL_DestroyRenderer(gb->gpu.renderer);
+	if (gb->gpu.window)
+		SDL_DestroyWindow(gb->gpu.window);
+
+	free(gb);
+}
@@ -0,0 +1,29 @@
+#ifndef GB_H
+#define GB_H
+
+#include "cpu.h"
+#include "gpu.h"
+#include "input.h"
+#include "memory.h"
+#include "sched.h"
+#include "time.h"
+#include "timer.h"
+
+// Whole state of one emulated Game Boy: every module reaches its own part and
+// the other components through it, so several consoles can run side by side
+struct gb {
+    struct cpu_context cpu;
+    struct mem_context mem;
+    struct gpu_context gpu;
+    struct input_context input;
+    struct sched_context sched;
+    struct time_context time;
+    struct timer_context timer;
+};
+
+struct gb *gb_create();
+void gb_init(struct gb *gb);
+void gb_reset(struct gb *gb);
+void gb_destroy(struct gb *gb);
+
+#endif
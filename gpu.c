@@ -1,7 +1,16 @@
-#include "cpu.h"
-#include "gpu.h"
-#include "memory.h"
-#include "time.h"
+#include "gb.h"
+
+// Tiles are decoded 2 rows at a time with SSE2 when the compiler targets it.
+// Define GPU_NO_SIMD to force the portable 64 bits version.
+#if defined(__SSE2__) && !defined(GPU_NO_SIMD)
+#define GPU_SIMD
+#include <emmintrin.h>
+#endif
+// Palettes are applied 8 pixels at a time, by a byte shuffle with SSSE3.
+#if defined(__SSSE3__) && !defined(GPU_NO_SIMD)
+#define GPU_SIMD_SHUFFLE
+#include <tmmintrin.h>
+#endif
 
 #define DURATION_HBLANK 204
 #define DURATION_VBLANK 4560
@@ -15,26 +24,66 @@
 #define COLOR32_BLACK 0xFF000000
 
 
-static uint8_t gpu_line = 0;
 
 const int SCREEN_WIDTH_VRAM = 1024;
 const int SCREEN_HEIGHT_VRAM = 32;
 
-const int SCREEN_WIDTH = 160;
-const int SCREEN_HEIGHT = 144;
+const int SCREEN_WIDTH = GPU_SCREEN_WIDTH;
+const int SCREEN_HEIGHT = GPU_SCREEN_HEIGHT;
 
-SDL_Window *window;
-SDL_Texture *texture;
-SDL_Surface *surface;
+#define SCALE_DEFAULT 2
 
-static uint8_t scale = 2;
+void gpu_set_scale(struct gb *gb, uint8_t value)
+{
+	gb->gpu.scale = value;
+}
+
+// without display, frames are only rendered into the framebuffer
+void gpu_set_headless(struct gb *gb, uint8_t value)
+{
+	gb->gpu.headless = value;
+}
+
+uint32_t gpu_get_frame_cpt(struct gb *gb)
+{
+	return gb->gpu.frame_cpt;
+}
+
+// read through LY
+uint8_t gpu_get_line(struct gb *gb)
+{
+	return gb->gpu.line;
+}
 
-void gpu_set_scale(uint8_t value)
+// read through STAT
+gpu_mode gpu_get_mode(struct gb *gb)
 {
-	scale = value;
+	return gb->gpu.mode;
 }
 
-int SDL_init()
+static void gpu_decode_sprites(struct gb *gb)
+{
+	uint8_t *oam = &gb->mem.memory[OAM_ADDR];
+
+	// go through each modified OAM u32 word
+	for (int i = 0; i < GPU_SPRITE_NB; i++, oam += 4) {
+		struct gpu_sprite *sprite = &gb->gpu.sprites[i];
+
+		if (!mem_dirty_test(gb, MEM_DIRTY_OAM, i))
+			continue;
+
+		sprite->y = oam[0] - 16;
+		sprite->x = oam[1] - 8;
+		sprite->tile_idx = oam[2];
+		sprite->layer = oam[3] >> 7;
+		sprite->y_flip = (oam[3] & 0x40) >> 6;
+		sprite->x_flip = (oam[3] & 0x20) >> 5;
+		sprite->palette = (oam[3] & 0x10) >> 4;
+	}
+	mem_dirty_clear_all(gb, MEM_DIRTY_OAM);
+}
+
+int SDL_init(struct gb *gb)
 {
 	int ret;
 
@@ -49,21 +98,34 @@ int SDL_init()
 		printf("Warning: Linear texture filtering not enabled!");
 	}
 
+	if (!gb->gpu.scale)
+		gb->gpu.scale = SCALE_DEFAULT;
+
 	// create window
-	window = SDL_CreateWindow("BalaBoy", SDL_WINDOWPOS_UNDEFINED,
-				  SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH * scale,
-				  SCREEN_HEIGHT * scale, SDL_WINDOW_SHOWN);
-	if (!window) {
+	gb->gpu.window = SDL_CreateWindow("BalaBoy", SDL_WINDOWPOS_UNDEFINED,
+					  SDL_WINDOWPOS_UNDEFINED,
+					  SCREEN_WIDTH * gb->gpu.scale,
+					  SCREEN_HEIGHT * gb->gpu.scale,
+					  SDL_WINDOW_SHOWN);
+	if (!gb->gpu.window) {
 		printf("SDL_SetVideoMode ERROR: %s\n", SDL_GetError());
 		return -1;
 	}
 
-	//SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0xFF, 0x00);
+	// frames are uploaded to a streaming texture, scaled by the renderer
+	gb->gpu.renderer = SDL_CreateRenderer(gb->gpu.window, -1,
+					      SDL_RENDERER_ACCELERATED);
+	if (!gb->gpu.renderer) {
+		printf("SDL_CreateRenderer ERROR: %s\n", SDL_GetError());
+		return -1;
+	}
 
-	// get window surface
-	surface = SDL_GetWindowSurface(window);
-	if (!surface) {
-		printf("SDL_GetWindowSurface ERROR: %s\n", SDL_GetError());
+	gb->gpu.texture = SDL_CreateTexture(gb->gpu.renderer,
+					    SDL_PIXELFORMAT_ARGB8888,
+					    SDL_TEXTUREACCESS_STREAMING,
+					    SCREEN_WIDTH, SCREEN_HEIGHT);
+	if (!gb->gpu.texture) {
+		printf("SDL_CreateTexture ERROR: %s\n", SDL_GetError());
 		return -1;
 	}
 
@@ -77,318 +139,230 @@ int SDL_init()
 	return 0;
 }
 
-uint8_t tile[64] = {};
-
-// debug function to investigate VRAM
-static int tile_set_line_VRAM(uint8_t line_nb, uint8_t B0, uint8_t B1,
-			      uint8_t *tile_matrix)
+// 2bpp planar to one color number per byte: bit 7 - x of B0 and B1 are
+// the low and high bits of the color of pixel x. Both versions decode a
+// whole tile (16 bytes) into its normal and X-flipped 8x8 forms.
+#ifdef GPU_SIMD
+static void gpu_decode_tile(const uint8_t *data, uint8_t *tile,
+			    uint8_t *tile_flip)
 {
-	uint8_t p0, p1;
-
-	for (int i = 0; i < 8; i++) {
-		p0 = (B0 >> (7 - i)) & 0x01;
-		p1 = ((B1 >> (7 - i)) << 1) & 0x2;
-		tile_matrix[line_nb * 8 + i] = p1 | p0;
+	const __m128i mask = _mm_setr_epi8(0x80, 0x40, 0x20, 0x10, 0x08, 0x04,
+					   0x02, 0x01, 0x80, 0x40, 0x20, 0x10,
+					   0x08, 0x04, 0x02, 0x01);
+	const __m128i mask_flip = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10,
+						0x20, 0x40, 0x80, 0x01, 0x02,
+						0x04, 0x08, 0x10, 0x20, 0x40,
+						0x80);
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i bytes = _mm_loadu_si128((const __m128i *)data);
+	__m128i B0, B1;
+
+	// split the B0 and B1 planes: row y in byte y of each
+	B0 = _mm_and_si128(bytes, _mm_set1_epi16(0x00FF));
+	B1 = _mm_srli_epi16(bytes, 8);
+	B0 = _mm_packus_epi16(B0, B0);
+	B1 = _mm_packus_epi16(B1, B1);
+	// then each row byte 8 times
+	B0 = _mm_unpacklo_epi8(B0, B0);
+	B1 = _mm_unpacklo_epi8(B1, B1);
+
+	for (int y = 0; y < 8; y += 2) {
+		// rows y and y + 1, one byte per pixel
+		__m128i lo = _mm_unpacklo_epi16(B0, B0);
+		__m128i hi = _mm_unpacklo_epi16(B1, B1);
+		__m128i px, px_flip;
+
+		lo = _mm_unpacklo_epi32(lo, lo);
+		hi = _mm_unpacklo_epi32(hi, hi);
+
+		px = _mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo, mask),
+						     mask), one),
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi, mask),
+						     mask), _mm_add_epi8(one, one)));
+		px_flip = _mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo, mask_flip),
+						     mask_flip), one),
+			_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi, mask_flip),
+						     mask_flip), _mm_add_epi8(one, one)));
+
+		_mm_storeu_si128((__m128i *)&tile[y * 8], px);
+		_mm_storeu_si128((__m128i *)&tile_flip[y * 8], px_flip);
+
+		// next 2 rows
+		B0 = _mm_srli_si128(B0, 4);
+		B1 = _mm_srli_si128(B1, 4);
 	}
-	return 0;
 }
-
-static int tile_set_line_background(uint8_t B0, uint8_t B1, uint8_t *addr)
+#else
+// each byte of the result keeps the bit of the byte selected by mask,
+// normalized to 0 or 1
+static uint64_t gpu_spread_bits(uint8_t b, uint64_t mask)
 {
-	uint8_t p0, p1, pp, pval;
-	uint8_t palette = mem_get_byte(0xff47);
-
-	// TODO : set BG palette here
-
-	for (int i = 0; i < 8; i++) {
-		p0 = (B0 >> (7 - i)) & 0x01;
-		p1 = ((B1 >> (7 - i)) << 1) & 0x2;
-		pp = p1 | p0;
-
-		pp = p1 | p0;
-
-		switch (pp) {
-		case 0x00:
-			pval = palette & 0x03;
-			break;
-		case 0x01:
-			pval = (palette >> 2) & 0x03;
-			break;
-		case 0x02:
-			pval = (palette >> 4) & 0x03;
-			break;
-		case 0x03:
-			pval = (palette >> 6) & 0x03;
-			break;
-		}
+	uint64_t x = (b * 0x0101010101010101ULL) & mask;
 
-		*(addr + i) = pval;
-	}
-	return 0;
+	return ((x + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
 }
 
-static uint8_t get_sprite_pixel(uint8_t pp, uint8_t palette_idx)
+static void gpu_decode_tile(const uint8_t *data, uint8_t *tile,
+			    uint8_t *tile_flip)
 {
-	uint8_t pval, palette_byte;
-
-	switch (palette_idx) {
-	case 0:
-		palette_byte = mem_get_byte(0xff48);
-		break;
-	case 1:
-		palette_byte = mem_get_byte(0xff49);
-		break;
-	default:
-		printf("[%s] invalid input palette value\n", __func__);
-		exit(0);
-	}
-
-	switch (pp) {
-	case 0x00:
-		pval = palette_byte & 0x03;
-		break;
-	case 0x01:
-		pval = (palette_byte >> 2) & 0x03;
-		break;
-	case 0x02:
-		pval = (palette_byte >> 4) & 0x03;
-		break;
-	case 0x03:
-		pval = (palette_byte >> 6) & 0x03;
-		break;
+	// in memory order: pixel 0 is bit 7, or bit 0 when flipped
+	const uint64_t mask = 0x0102040810204080ULL;
+	const uint64_t mask_flip = 0x8040201008040201ULL;
+
+	for (int y = 0; y < 8; y++) {
+		uint64_t px = gpu_spread_bits(data[y * 2], mask) |
+			      gpu_spread_bits(data[y * 2 + 1], mask) << 1;
+		uint64_t px_flip = gpu_spread_bits(data[y * 2], mask_flip) |
+				   gpu_spread_bits(data[y * 2 + 1], mask_flip) << 1;
+
+		// byte x of the values is pixel x, whatever the host byte order
+		for (int x = 0; x < 8; x++) {
+			tile[y * 8 + x] = px >> (x * 8);
+			tile_flip[y * 8 + x] = px_flip >> (x * 8);
+		}
 	}
-
-	return pval;
 }
+#endif
 
-static int tile_set_line_sprite(uint8_t B0, uint8_t B1, uint8_t layer,
-				uint8_t x_flip, uint8_t palette, uint8_t *addr)
+// Shades of the 8 color numbers of a tile row, through a 4 entries palette
+#ifdef GPU_SIMD_SHUFFLE
+static void gpu_apply_palette(uint8_t *dst, const uint8_t *row,
+			      const uint8_t *colors)
 {
-	uint8_t p0, p1, pp, ppalette;
-
-	// TODO: factorize in one loop
-	if (x_flip) {
-		for (int i = 7; i >= 0; i--) {
-			p0 = (B0 >> (7 - i)) & 0x01;
-			p1 = ((B1 >> (7 - i)) << 1) & 0x2;
-			pp = p1 | p0;
-
-			ppalette = get_sprite_pixel(pp, palette);
-
-			// ignore blank sprite pixel since they are transparent
-			if (ppalette)
-				continue;
-
-			// above BG
-			if (layer == 0) {
-				*(addr + i) = ppalette;
-			}
-			// under BG
-			else {
-				// print pixel only if BG pixel is WHITE (= 0xFF ?)
-				if (*(addr + i) == 0x00)
-					*(addr + i) = ppalette;
-			}
-		}
-	} else {
-		for (int i = 0; i < 8; i++) {
-			p0 = (B0 >> (7 - i)) & 0x01;
-			p1 = ((B1 >> (7 - i)) << 1) & 0x2;
-			pp = p1 | p0;
-
-			ppalette = get_sprite_pixel(pp, palette);
-
-			// ignore blank sprite pixel since they are transparent
-			if (ppalette == 0x00)
-				continue;
-
-			// above BG
-			if (layer == 0) {
-				*(addr + i) = ppalette;
-			}
-			// under BG
-			else {
-				// print pixel only if BG pixel is WHITE (= 0xFF ?)
-				if (*(addr + i) == 0x00)
-					*(addr + i) = ppalette;
-			}
-		}
-	}
+	uint32_t lut;
 
-	return 0;
+	memcpy(&lut, colors, 4);
+	_mm_storel_epi64((__m128i *)dst,
+			 _mm_shuffle_epi8(_mm_cvtsi32_si128(lut),
+					  _mm_loadl_epi64((const __m128i *)row)));
+}
+#else
+static void gpu_apply_palette(uint8_t *dst, const uint8_t *row,
+			      const uint8_t *colors)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	uint64_t px, lo, hi, shades;
+
+	// each byte is processed by itself, so the host byte order does not
+	// matter: one 0x01 per byte holding each color number, times its shade
+	memcpy(&px, row, 8);
+	lo = px & ones;
+	hi = (px >> 1) & ones;
+	shades = (~(lo | hi) & ones) * colors[0] +
+		 (lo & ~hi) * colors[1] +
+		 (hi & ~lo) * colors[2] +
+		 (lo & hi) * colors[3];
+	memcpy(dst, &shades, 8);
 }
+#endif
 
-// debug function to investigate VRAM
-static int tile_set_VRAM(uint16_t first_byte_addr, uint8_t *tile_matrix)
+// Tiles are decoded to 2 bits color numbers when their VRAM bytes change,
+// in both directions so that X-flipped sprites are read the same way
+static void gpu_decode_tiles(struct gb *gb)
 {
-	uint8_t B0, B1;
+	for (int i = 0; i < GPU_TILE_NB; i++) {
+		if (!mem_dirty_test(gb, MEM_DIRTY_TILES, i))
+			continue;
 
-	for (int i = 0; i < 8; i++) {
-		B0 = mem_get_byte(first_byte_addr + i * 2);
-		B1 = mem_get_byte(first_byte_addr + i * 2 + 1);
-		tile_set_line_VRAM(i, B0, B1, tile_matrix);
+		gpu_decode_tile(&gb->mem.memory[0x8000 + i * 16],
+				&gb->gpu.tiles[i][0][0],
+				&gb->gpu.tiles_flip[i][0][0]);
 	}
-	return 0;
+	mem_dirty_clear_all(gb, MEM_DIRTY_TILES);
 }
 
-// debug function to display the full content of VRAM
-/*static int draw_frame_VRAM()
+// value: the palette register, 2 bits of shade per color number
+void gpu_set_palette(struct gb *gb, gpu_palette palette, uint8_t value)
 {
-	static uint32_t cpt_w = 0;
-	static uint32_t cpt_lg = 0;
-	static uint32_t cpt_dg = 0;
-	static uint32_t cpt_d = 0;
-
-	for (int l = 0; l < 4; l++) {
-		for (int k = 0; k < 128; k++) {
-			tile_set_VRAM(0x8000 + 0x800 * l + 16 * k, tile);
-
-			for (int i = 0; i < 8; i++) {
-				for (int j = 0; j < 8; j++) {
-					switch (tile[i + j * 8]) {
-					case 0:
-						SDL_SetRenderDrawColor(
-							renderer, 0xFF, 0xFF,
-							0xFF, 0xFF);
-						cpt_w++;
-						break;
-					case 1:
-						SDL_SetRenderDrawColor(
-							renderer, 0xAA, 0xAA,
-							0xAA, 0xFF);
-						cpt_lg++;
-						break;
-					case 2:
-						SDL_SetRenderDrawColor(
-							renderer, 0x55, 0x55,
-							0x55, 0xFF);
-						cpt_dg++;
-						break;
-					case 3:
-						SDL_SetRenderDrawColor(
-							renderer, 0x00, 0x00,
-							0x00, 0xFF);
-						cpt_d++;
-						break;
-					default:
-						break;
-					}
-					SDL_RenderDrawPoint(renderer, i + 8 * k,
-							    j + l * 8);
-				}
-			}
-		}
-	}
-
-	//printf("[pixel_distribution][w,lg,dg,d] %u, %u, %u, %u\n", cpt_w, cpt_lg, cpt_dg, cpt_d);
+	for (int i = 0; i < 4; i++)
+		gb->gpu.palettes[palette][i] = (value >> (i * 2)) & 0x03;
+}
 
-	return 0;
-}*/
+static int draw_frame_SCREEN(struct gb *gb)
+{
+	static const uint32_t color32[4] = {
+		COLOR32_WHITE, COLOR32_LIGHTGRAY, COLOR32_DARKGRAY, COLOR32_BLACK,
+	};
+	uint32_t *pixel = gb->gpu.pixels;
+	int x, y;
 
-uint8_t background[256 * 256] = {};
+	for (y = 0; y < SCREEN_HEIGHT; y++) {
+		uint8_t *line = &gb->gpu.framebuffer[y * SCREEN_WIDTH];
 
-static int draw_frame_SCREEN()
-{
-	// DBG: display BG ///////////////////////////////////////
-	// TODO: display only screen, not full background
-	int x, y, color32;
-	for (y = 0; y < 256; y++) {
-		for (x = 0; x < 256; x++) {
-			switch (background[y * 256 + x]) {
-			case 0:
-				color32 = COLOR32_WHITE;
-				break;
-			case 1:
-				color32 = COLOR32_LIGHTGRAY;
-				break;
-			case 2:
-				color32 = COLOR32_DARKGRAY;
-				break;
-			case 3:
-				color32 = COLOR32_BLACK;
-				break;
-			default:
-				break;
-			}
-			SDL_Rect rect = {x*scale, y*scale, scale, scale}; // x, y, width, height
-			SDL_FillRect(surface, &rect, color32);
-		}
+		for (x = 0; x < SCREEN_WIDTH; x++)
+			*pixel++ = color32[line[x] & 0x03];
 	}
-	memset(background, 0, 256 * 256);
-	SDL_UpdateWindowSurface(window);
 
-	static int frame_cpt = 0;
-	//printf("frame_cpt = %d\n", frame_cpt);
-	frame_cpt++;
+	SDL_UpdateTexture(gb->gpu.texture, NULL, gb->gpu.pixels,
+			  SCREEN_WIDTH * sizeof(uint32_t));
+	SDL_RenderCopy(gb->gpu.renderer, gb->gpu.texture, NULL, NULL);
+	SDL_RenderPresent(gb->gpu.renderer);
+
+	//printf("frame_cpt = %d\n", gb->gpu.frame_cpt);
 
 	return 0;
 }
 
-static int gpu_set_line_background(uint8_t line)
+// Only the 160x144 viewport is rendered: the background is 256x256 pixels
+// (32x32 tiles) scrolled by SCX/SCY, wrapping around its edges
+static int gpu_set_line_background(struct gb *gb, uint8_t line)
 {
 	uint16_t tile_map_addr;
-	uint16_t tile_data_addr;
-	uint8_t lcdc = mem_get_byte(LCDC);
-
-	// proceed only if background is enable
-	if (!(lcdc & 0x01))
+	uint8_t lcdc = mem_get_byte(gb, LCDC);
+	uint8_t scx = mem_get_byte(gb, SCX);
+	uint8_t *dst = &gb->gpu.framebuffer[line * SCREEN_WIDTH];
+	uint8_t y = line + mem_get_byte(gb, SCY);
+	uint8_t *colors = gb->gpu.palettes[GPU_PALETTE_BG];
+
+	// proceed only if background is enable, otherwise it is white
+	if (!(lcdc & 0x01)) {
+		memset(dst, 0, SCREEN_WIDTH);
 		return 0;
+	}
 
 	if (lcdc & 0x08)
 		tile_map_addr = 0x9C00;
 	else
 		tile_map_addr = 0x9800;
+	tile_map_addr += (y / 8) * 32;
 
-	if (lcdc & 0x10)
-		tile_data_addr = 0x8000;
-	else
-		tile_data_addr = 0x8800;
-
-	int idx_max = 0;
-
-	/*if (line == 0)
-		printf("[bginfo] tile map = 0x%x, tile_data = 0x%x\n",
-		       tile_map_addr, tile_data_addr);*/
-
-	// TODO: use SCX & SCY !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-	/*if(line % 8 == 1)
-		printf("[%d] ", line);*/
-
-	for (int i = 0; i < 20; i++) {
+	// from the tile holding the first visible pixel, which may be partly
+	// on the left of the screen
+	for (int x = -(scx % 8); x < SCREEN_WIDTH; x += 8) {
 		uint8_t tile_idx =
-			mem_get_byte(tile_map_addr + (line / 8) * 32 + i);
-
-		/*int idx = (line/8)*32*64 + (line%8)*256 + i*8;
-		printf("%-3x,", tile_idx);*/
-
-		//int idxB = (line/8)*32*64 + (line%8)*256 + i*8;
-		uint16_t tile_line_addr =
-			tile_data_addr + tile_idx * 16 + (line % 8) * 2;
-		uint8_t B0 = mem_get_byte(tile_line_addr);
-		uint8_t B1 = mem_get_byte(tile_line_addr + 1);
-		int idxPixel = line * 256 + i * 8;
-		//printf("%-3d,", idxPixel);
-		//printf("%-3x,", idxB);
-		//printf("0x%x,", tile_line_addr);
-		/*if(line % 8 == 1) {
-			//printf("@%x=", tile_line_addr);
-			//printf("0x%x,", B0);
-			printf("%-3d,", tile_idx);
-		}*/
-
-		// TODO: support BG palette
-		tile_set_line_background(B0, B1, &background[idxPixel]);
+			gb->mem.memory[tile_map_addr + ((x + scx) / 8) % 32];
+		uint16_t tile;
+		uint8_t *row;
+
+		// tile data at 0x8000, or 0x8800 with signed numbers around
+		// 0x9000
+		if (lcdc & 0x10)
+			tile = tile_idx;
+		else
+			tile = 256 + (int8_t)tile_idx;
+		row = gb->gpu.tiles[tile][y % 8];
+
+		if (x >= 0 && x + 8 <= SCREEN_WIDTH) {
+			gpu_apply_palette(&dst[x], row, colors);
+		} else {
+			uint8_t shades[8];
+
+			gpu_apply_palette(shades, row, colors);
+			for (int i = 0; i < 8; i++)
+				if (x + i >= 0 && x + i < SCREEN_WIDTH)
+					dst[x + i] = shades[i];
+		}
 	}
-	/*if(line % 8 == 1)
-		printf("\n");*/
 
 	return 0;
 }
 
-static int gpu_set_line_sprite(uint8_t line)
+static int gpu_set_line_sprite(struct gb *gb, uint8_t line)
 {
-	uint16_t sprite_data_addr = 0x8000;
-	uint8_t lcdc = mem_get_byte(LCDC);
+	uint8_t lcdc = mem_get_byte(gb, LCDC);
+	uint8_t *dst = &gb->gpu.framebuffer[line * SCREEN_WIDTH];
 
 	// TODO: manage 8x16 sprites (when bit2 of LCDC == 1)
 
@@ -396,124 +370,137 @@ static int gpu_set_line_sprite(uint8_t line)
 	if (!(lcdc & 0x01))
 		return 0;
 
-	// go through each OAM u32 word
-	for (int i = 0; i < 40; i++) {
-		uint8_t y = mem_get_byte(OAM_ADDR + i * 4) - 16;
+	if (mem_dirty_any(gb, MEM_DIRTY_OAM))
+		gpu_decode_sprites(gb);
+
+	for (int i = 0; i < GPU_SPRITE_NB; i++) {
+		struct gpu_sprite *sprite = &gb->gpu.sprites[i];
+		uint8_t y = sprite->y;
+		uint8_t *colors =
+			gb->gpu.palettes[GPU_PALETTE_OBP0 + sprite->palette];
+		uint8_t row_nb;
+		uint8_t *row;
+		uint8_t shades[8];
 
 		// sprite must be contained on the current line
-		if (line >= y && line <= (y + 7)) {
-			uint8_t x = mem_get_byte(OAM_ADDR + i * 4 + 1) - 8;
-			uint8_t tile_idx = mem_get_byte(OAM_ADDR + i * 4 + 2);
-			uint8_t info = mem_get_byte(OAM_ADDR + i * 4 + 3);
-			uint8_t layer = info >> 7;
-			uint8_t y_flip = (info & 0x40) >> 6;
-			uint8_t x_flip = (info & 0x20) >> 5;
-			uint8_t palette = (info & 0x10) >> 4;
-
-			uint8_t B0, B1;
-
-			uint16_t tile_addr = sprite_data_addr +
-					     tile_idx * 16 /*+ (line%8) * 2*/;
-
-			if (y_flip)
-				tile_addr += (8 - line % 8) * 2;
-			else
-				tile_addr += (line % 8) * 2;
-
-			B0 = mem_get_byte(tile_addr);
-			B1 = mem_get_byte(tile_addr + 1);
-
-			int idxPixel = line * 256 + x;
-			tile_set_line_sprite(B0, B1, layer, x_flip, palette,
-					     &background[idxPixel]);
+		if (line < y || line > (y + 7))
+			continue;
+
+		row_nb = line - y;
+		if (sprite->y_flip)
+			row_nb = 7 - row_nb;
+		if (sprite->x_flip)
+			row = gb->gpu.tiles_flip[sprite->tile_idx][row_nb];
+		else
+			row = gb->gpu.tiles[sprite->tile_idx][row_nb];
+		gpu_apply_palette(shades, row, colors);
+
+		for (int j = 0; j < 8; j++) {
+			int x = sprite->x + j;
+
+			// color 0 is transparent
+			if (x < 0 || x >= SCREEN_WIDTH || !row[j])
+				continue;
+
+			// under BG, only drawn over white pixels
+			if (sprite->layer && dst[x])
+				continue;
+
+			dst[x] = shades[j];
 		}
 	}
-}
 
-static int cptt;
+	return 0;
+}
 
-int gpu_processing(uint8_t op_duration)
+// duration of the current mode
+static uint32_t gpu_get_mode_duration(struct gb *gb)
 {
-	static uint8_t mode = 2; // KO if = 0
-	static uint32_t time_gpu = 4;
-
-	time_gpu += op_duration;
-
-	/*printf("[gpu_loop] time_gpu = %d, mode = %d, linr_prev = %d, line = %d\n",
-	       time_gpu, mode, line_prev, gpu_line);*/
-
-	switch (mode) {
+	switch (gb->gpu.mode) {
 	case HBLANK:
-		if (time_gpu > DURATION_HBLANK) {
-			time_gpu -= DURATION_HBLANK;
-			gpu_line++;
-			//printf("[%d] line set to %d\n", __LINE__, gpu_line);
-			mem_set_byte(LY, gpu_line);
-			if (gpu_line >= 144) {
-				mode = VBLANK;
-				// Trigger VBLANK interrupt
-				/*printf("=> trigger VBLANK interrupt #%d\n",
-				       cptt);*/
-				cptt++;
-				uint8_t val = mem_get_byte(IF);
-				mem_set_byte(IF, val | INT_VBLANK);
+		return DURATION_HBLANK;
+	case VBLANK:
+		return DURATION_LINE;
+	case OAM_ACCESS:
+		return DURATION_OAM;
+	default:
+		return DURATION_LCD;
+	}
+}
 
+// scheduled at the end of each mode
+static void gpu_mode_end(struct gb *gb, uint64_t deadline)
+{
+	switch (gb->gpu.mode) {
+	case HBLANK:
+		gb->gpu.line++;
+		//printf("[%d] line set to %d\n", __LINE__, gb->gpu.line);
+		if (gb->gpu.line >= 144) {
+			gb->gpu.mode = VBLANK;
+			// Trigger VBLANK interrupt
+			/*printf("=> trigger VBLANK interrupt #%d\n",
+			       gb->gpu.frame_cpt);*/
+			gb->gpu.frame_cpt++;
+			uint8_t val = mem_get_byte(gb, IF);
+			mem_set_byte(gb, IF, val | INT_VBLANK);
+
+			if (!gb->gpu.headless) {
 				// dbg functions
-				//draw_frame_VRAM();
-				draw_frame_SCREEN();
-				//dump_VRAM();
-
-        		// Regulate framerate
-				time_regulate_framerate();
-			} else {
-				mode = OAM_ACCESS;
+				draw_frame_SCREEN(gb);
+				//dump_VRAM(gb);
+
+				// Regulate framerate
+				time_regulate_framerate(gb);
 			}
+		} else {
+			gb->gpu.mode = OAM_ACCESS;
 		}
 		break;
 
 	case VBLANK:
-		if (time_gpu > DURATION_LINE) {
-			time_gpu -= DURATION_LINE;
-
-			//printf("[%d] line set to %d\n", __LINE__, gpu_line);
+		//printf("[%d] line set to %d\n", __LINE__, gb->gpu.line);
 
-			if (gpu_line >= 153) {
-				mode = OAM_ACCESS;
-				gpu_line = 0;
+		if (gb->gpu.line >= 153) {
+			gb->gpu.mode = OAM_ACCESS;
+			gb->gpu.line = 0;
 
-				//printf("\n");
+			//printf("\n");
 
-				//printf("[%d] line set to %d\n", __LINE__, gpu_line);
-				// TODO: move SDL rendering in gpu.c
-				//gpu_render_frame();
-			} else {
-				gpu_line++;
-			}
-
-			mem_set_byte(LY, gpu_line);
+			//printf("[%d] line set to %d\n", __LINE__, gb->gpu.line);
+			// TODO: move SDL rendering in gpu.c
+			//gpu_render_frame();
+		} else {
+			gb->gpu.line++;
 		}
 		break;
 
 	case OAM_ACCESS:
-		if (time_gpu > DURATION_OAM) {
-			time_gpu -= DURATION_OAM;
-			mode = LCD_DRAWING;
-			//gpu_set_line_background(gpu_line);
-		}
+		gb->gpu.mode = LCD_DRAWING;
+		//gpu_set_line_background(gb, gb->gpu.line);
 		break;
 
 	case LCD_DRAWING:
-		if (time_gpu > DURATION_LCD) {
-			time_gpu -= DURATION_LCD;
-			mode = HBLANK;
-			gpu_set_line_background(gpu_line);
-			gpu_set_line_sprite(gpu_line);
-		}
-
+		gb->gpu.mode = HBLANK;
+		if (mem_dirty_any(gb, MEM_DIRTY_TILES))
+			gpu_decode_tiles(gb);
+		gpu_set_line_background(gb, gb->gpu.line);
+		gpu_set_line_sprite(gb, gb->gpu.line);
 		break;
 
 	default:
 		printf("[%s] ERROR: invalid mode, should not happen\n",
 		       __func__);
 	}
+
+	sched_schedule(gb, SCHED_GPU, deadline + gpu_get_mode_duration(gb),
+		       gpu_mode_end);
+}
+
+void gpu_init(struct gb *gb)
+{
+	gb->gpu.mode = OAM_ACCESS;
+	gb->gpu.line = 0;
+	sched_schedule(gb, SCHED_GPU,
+		       sched_get_time(gb) + gpu_get_mode_duration(gb),
+		       gpu_mode_end);
 }
@@ -1,3 +1,6 @@
+#ifndef GPU_H
+#define GPU_H
+
 #include <stdio.h>
 #include <stdint.h>
 
@@ -11,6 +14,59 @@ typedef enum {
     LCD_DRAWING = 3
 } gpu_mode;
 
-void gpu_set_scale(uint8_t value);
-int gpu_processing(uint8_t op_duration);
-int SDL_init();
\ No newline at end of file
+struct gb;
+
+// palettes indexes, sprites select OBP0 or OBP1 by their attributes
+typedef enum {
+    GPU_PALETTE_BG,
+    GPU_PALETTE_OBP0,
+    GPU_PALETTE_OBP1,
+    GPU_PALETTE_NB
+} gpu_palette;
+
+#define GPU_SPRITE_NB       40
+#define GPU_TILE_NB         384
+#define GPU_SCREEN_WIDTH    160
+#define GPU_SCREEN_HEIGHT   144
+
+// sprite attributes, decoded again only when their OAM entry changes
+struct gpu_sprite {
+    uint8_t y;                  // screen position of the top left pixel
+    int16_t x;                  // may be partly off screen
+    uint8_t tile_idx;
+    uint8_t layer;
+    uint8_t y_flip;
+    uint8_t x_flip;
+    uint8_t palette;
+};
+
+struct gpu_context {
+    uint8_t line;
+    uint8_t mode;
+    uint8_t scale;              // 0 for the default one
+    uint8_t headless;           // no window, nor framerate regulation
+    uint32_t frame_cpt;
+    struct gpu_sprite sprites[GPU_SPRITE_NB];
+    // VRAM tiles decoded to color numbers, as is and X-flipped
+    uint8_t tiles[GPU_TILE_NB][8][8];
+    uint8_t tiles_flip[GPU_TILE_NB][8][8];
+    // shade of each color number, rebuilt when BGP, OBP0 or OBP1 is written
+    uint8_t palettes[GPU_PALETTE_NB][4];
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+    uint32_t pixels[GPU_SCREEN_WIDTH * GPU_SCREEN_HEIGHT];  // texture upload
+    // color of each pixel of the screen, kept until the line is drawn again
+    uint8_t framebuffer[GPU_SCREEN_WIDTH * GPU_SCREEN_HEIGHT];
+};
+
+void gpu_set_scale(struct gb *gb, uint8_t value);
+void gpu_set_headless(struct gb *gb, uint8_t value);
+uint32_t gpu_get_frame_cpt(struct gb *gb);
+uint8_t gpu_get_line(struct gb *gb);
+void gpu_set_palette(struct gb *gb, gpu_palette palette, uint8_t value);
+gpu_mode gpu_get_mode(struct gb *gb);
+void gpu_init(struct gb *gb);
+int SDL_init(struct gb *gb);
+
+#endif
@@ -1,47 +1,31 @@
 #include <SDL2/SDL.h>
 
-#include "cpu.h"
-#include "memory.h"
+#include "gb.h"
 
 #define KEY_PRESSED 1
 #define KEY_NOT_PRESSED 0
 
-struct input_keys {
-	uint8_t up;
-	uint8_t down;
-	uint8_t left;
-	uint8_t right;
-	uint8_t A;
-	uint8_t B;
-	uint8_t start;
-	uint8_t select;
-};
-
-static struct input_keys keys = {};
-static struct input_keys keys_prev = {};
-
-static SDL_Event event;
-
-uint8_t input_get()
+uint8_t input_get(struct gb *gb)
 {
-	uint8_t reg = mem_get_byte(P1);
+	struct input_keys *keys = &gb->input.keys;
+	uint8_t reg = mem_get_byte(gb, P1);
 	uint8_t P15 = (reg >> 5) & 0x01;
 	uint8_t P14 = (reg >> 4) & 0x01;
 	uint8_t val = 0x00;
 
 	if (P14) {
-		val |= keys.down << 3;
-		val |= keys.up << 2;
-		val |= keys.left << 1;
-		val |= keys.right;
+		val |= keys->down << 3;
+		val |= keys->up << 2;
+		val |= keys->left << 1;
+		val |= keys->right;
 		/*if(val)
             printf("[P14] val=0x%x, 0x%x\n", val, ~val);*/
 	}
 	else if (P15) {
-		val |= keys.select << 3;
-		val |= keys.start << 2;
-		val |= keys.B << 1;
-		val |= keys.A;
+		val |= keys->select << 3;
+		val |= keys->start << 2;
+		val |= keys->B << 1;
+		val |= keys->A;
 		/*if(val)
             printf("[P15] val=0x%x, 0x%x\n", val, ~val)*/;
 	}
@@ -49,20 +33,45 @@ uint8_t input_get()
 	return ~val;
 }
 
-void input_init()
+void input_init(struct gb *gb)
 {
-	memset(&keys, KEY_NOT_PRESSED, sizeof(keys));
-	memset(&keys_prev, KEY_NOT_PRESSED, sizeof(keys_prev));
+	memset(&gb->input.keys, KEY_NOT_PRESSED, sizeof(gb->input.keys));
 }
 
-void input_scan()
+// keys set by the host instead of the keyboard, as for a scripted session
+void input_set_keys(struct gb *gb, struct input_keys *keys)
 {
+	uint8_t *prev = (uint8_t *)&gb->input.keys;
+	uint8_t *next = (uint8_t *)keys;
+
+	// a key press requests the joypad interrupt, and ends STOP
+	for (int i = 0; i < sizeof(*keys); i++) {
+		if (next[i] && !prev[i]) {
+			mem_set_byte(gb, IF, mem_get_byte(gb, IF) | INT_JOYPAD);
+			break;
+		}
+	}
+
+	gb->input.keys = *keys;
+}
+
+// the game window was closed or escape pressed
+uint8_t input_quit_requested(struct gb *gb)
+{
+	return gb->input.quit;
+}
+
+void input_scan(struct gb *gb)
+{
+	struct input_keys *keys = &gb->input.keys;
+	SDL_Event event;
 	uint8_t key_status;
 
 	while (SDL_PollEvent(&event) != 0) {
 		if (event.type == SDL_QUIT) {
 			printf("Exit game\n");
-			exit(0);
+			gb->input.quit = 1;
+			continue;
 		}
 
 		if (event.type == SDL_KEYDOWN) {
@@ -70,80 +79,73 @@ void input_scan()
 			switch (event.key.keysym.sym) {
 			case SDLK_ESCAPE:
 				printf("Exit game\n");
-				exit(0);
-				break;
+				gb->input.quit = 1;
+				continue;
 			case SDLK_UP:
-				keys.up = key_status;
+				keys->up = key_status;
 				break;
 			case SDLK_DOWN:
-				keys.down = key_status;
+				keys->down = key_status;
 				break;
 			case SDLK_LEFT:
-				keys.left = key_status;
+				keys->left = key_status;
 				break;
 			case SDLK_RIGHT:
-				keys.right = key_status;
+				keys->right = key_status;
 				break;
 			case SDLK_w:
-				keys.A = key_status;
+				keys->A = key_status;
 				break;
 			case SDLK_x:
-				keys.B = key_status;
+				keys->B = key_status;
 				break;
 			case SDLK_SPACE:
-				keys.start = key_status;
+				keys->start = key_status;
 				break;
 			case SDLK_LALT:
-				keys.select = key_status;
+				keys->select = key_status;
 				break;
 			default:
 				continue;
 			}
+
+			// a key press requests the joypad interrupt, and ends STOP
+			if (!event.key.repeat)
+				mem_set_byte(gb, IF, mem_get_byte(gb, IF) | INT_JOYPAD);
 		} else if (event.type == SDL_KEYUP) {
 			key_status = KEY_NOT_PRESSED;
 			switch (event.key.keysym.sym) {
 			case SDLK_ESCAPE:
 				printf("Exit game\n");
-				exit(0);
-				break;
+				gb->input.quit = 1;
+				continue;
 			case SDLK_UP:
-				keys.up = key_status;
+				keys->up = key_status;
 				break;
 			case SDLK_DOWN:
-				keys.down = key_status;
+				keys->down = key_status;
 				break;
 			case SDLK_LEFT:
-				keys.left = key_status;
+				keys->left = key_status;
 				break;
 			case SDLK_RIGHT:
-				keys.right = key_status;
+				keys->right = key_status;
 				break;
 			case SDLK_w:
-				keys.A = key_status;
+				keys->A = key_status;
 				break;
 			case SDLK_x:
-				keys.B = key_status;
+				keys->B = key_status;
 				break;
 			case SDLK_SPACE:
-				keys.start = key_status;
+				keys->start = key_status;
 				break;
 			case SDLK_LALT:
-				keys.select = key_status;
+				keys->select = key_status;
 				break;
 			default:
 				continue;
 			}
 		}
 	}
-
-	// display input change
-	if (memcmp(&keys, &keys_prev, sizeof(keys))) {
-		memset(&keys_prev, 0, sizeof(keys));
-		if (memcmp(&keys, &keys_prev, sizeof(keys)))
-			printf("keys changed => U=%d, D=%d, L=%d, R=%d, A=%d, B=%d, START=%d, SELECT=%d\n",
-			       keys.up, keys.down, keys.left, keys.right,
-			       keys.A, keys.B, keys.start, keys.select);
-	}
-
-	keys_prev = keys;
 }
\ No newline at end of file
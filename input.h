@@ -1,5 +1,30 @@
+#ifndef INPUT_H
+#define INPUT_H
+
 #include <stdint.h>
 
-void input_scan();
-void input_init();
-uint8_t input_get();
\ No newline at end of file
+struct gb;
+
+struct input_keys {
+    uint8_t up;
+    uint8_t down;
+    uint8_t left;
+    uint8_t right;
+    uint8_t A;
+    uint8_t B;
+    uint8_t start;
+    uint8_t select;
+};
+
+struct input_context {
+    struct input_keys keys;
+    uint8_t quit;
+};
+
+void input_scan(struct gb *gb);
+void input_set_keys(struct gb *gb, struct input_keys *keys);
+uint8_t input_quit_requested(struct gb *gb);
+void input_init(struct gb *gb);
+uint8_t input_get(struct gb *gb);
+
+#endif
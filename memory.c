@@ -1,18 +1,19 @@
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#include "input.h"
-#include "memory.h"
+#include "gb.h"
 
-// declare locally the memory array
-static uint8_t memory[MEMORY_SIZE];
-
-static struct cartridge_info cart;
+static void mem_save_event(struct gb *gb, uint64_t deadline);
 
 // debug function
-int dump_VRAM()
+int dump_VRAM(struct gb *gb)
 {
 	static int i = 0;
 	i++;
@@ -25,295 +26,945 @@ int dump_VRAM()
 	snprintf(filename, 64, "/tmp/dump_vram_balaboy_%d", i);
 	fd = fopen(filename, "w");
 
-	fwrite(memory + 0x8000, 0x2000, 1, fd);
+	fwrite(gb->mem.memory + 0x8000, 0x2000, 1, fd);
 	fclose(fd);
 
 	return 0;
 }
 
-static void mem_OAM_copy(uint8_t start_addr)
+// Point page_nb guest pages from first_page to host memory, writes go through
+// the slow path if not writable
+static void mem_map(struct gb *gb, uint8_t first_page, uint16_t page_nb,
+		    uint8_t *host, int writable)
 {
-	uint16_t src = start_addr << 8;
-	memcpy(&memory[0xFE00], &memory[src], 0xA0);
-	//TODO: wait 160 usec
+	for (uint16_t i = 0; i < page_nb; i++) {
+		uint8_t *page = host ? host + i * MEM_PAGE_SIZE : NULL;
+
+		gb->mem.read_page[first_page + i] = page;
+		gb->mem.write_page[first_page + i] = writable ? page : NULL;
+	}
 }
 
-uint8_t mem_get_byte(uint16_t addr)
+// Banks are switched by re-pointing the pages of their window, the accesses
+// themselves never compute a bank offset
+static void mem_map_ROM_banks(struct gb *gb)
 {
-	if (cart.type == TYPE_MBC1 || cart.type == TYPE_MBC1_RAM ||
-	    cart.type == TYPE_MBC1_RAM_BATT) {
-		uint16_t offset;
-		uint16_t idx;
-		if (addr >= 0x4000 && addr < 0x7fff) {
-			offset = BANK_SIZE_ROM * cart.ROM_bank_active;
-			idx = addr - 0x4000;
-			return cart.mem[offset + idx];
-		}
-		if (addr >= 0xA000 && addr < 0xBfff &&
-		    cart.RAM_banking_enable) {
-			offset = BANK_SIZE_RAM * cart.RAM_bank_active;
-			idx = addr - 0xA000;
-			return cart.mem[offset + idx];
-		}
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	if (!cart->mem)
+		return;
+
+	mem_map(gb, 0x00, BANK_SIZE_ROM / MEM_PAGE_SIZE,
+		cart->mem + cart->ROM_bank_low * BANK_SIZE_ROM, 0);
+	mem_map(gb, 0x40, BANK_SIZE_ROM / MEM_PAGE_SIZE,
+		cart->mem + cart->ROM_bank_active * BANK_SIZE_ROM, 0);
+}
+
+// disabled or missing cartridge RAM is left to the slow path
+static void mem_map_RAM_bank(struct gb *gb)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	if (cart->mbc == MBC_NONE && !cart->RAM) {
+		mem_map(gb, 0xA0, BANK_SIZE_RAM / MEM_PAGE_SIZE,
+			gb->mem.memory + 0xA000, 1);
+		return;
 	}
 
-	if (addr == 0xFF00) { // P1
-		return 0xC0 | (memory[addr] & 0x3F);
+	if (!cart->RAM || !cart->RAM_banking_enable || cart->RTC_select) {
+		mem_map(gb, 0xA0, BANK_SIZE_RAM / MEM_PAGE_SIZE, NULL, 0);
+		return;
 	}
 
-	return memory[addr];
+	// MBC2 RAM is mirrored all over the window, its writes need the slow
+	// path to keep the upper 4 bits set
+	if (cart->mbc == MBC_2) {
+		for (int i = 0; i < BANK_SIZE_RAM; i += MBC2_RAM_SIZE)
+			mem_map(gb, 0xA0 + i / MEM_PAGE_SIZE,
+				MBC2_RAM_SIZE / MEM_PAGE_SIZE, cart->RAM, 0);
+		return;
+	}
+
+	mem_map(gb, 0xA0, BANK_SIZE_RAM / MEM_PAGE_SIZE,
+		cart->RAM + cart->RAM_bank_active * BANK_SIZE_RAM, 1);
 }
 
-void mem_set_byte(uint16_t addr, uint8_t value)
+static const struct mem_dirty_layout {
+	uint16_t start;
+	uint16_t end;
+	uint8_t shift;          // log2 of the bytes covered by one bit
+} dirty_layout[MEM_DIRTY_NB] = {
+	[MEM_DIRTY_TILES]	= { 0x8000, 0x9800, 4 },
+	[MEM_DIRTY_MAPS]	= { 0x9800, 0xA000, 0 },
+	[MEM_DIRTY_OAM]		= { OAM_ADDR, OAM_ADDR + OAM_SIZE, 2 },
+};
+
+static void mem_dirty_set(struct gb *gb, mem_dirty_area area, uint16_t idx)
 {
-	uint8_t tmp;
+	gb->mem.dirty[area][idx / 64] |= 1ULL << (idx % 64);
+}
 
-	// Do no overwrite cartridge ROM
-	if (addr < 0x8000)
+static void mem_dirty_set_all(struct gb *gb, mem_dirty_area area)
+{
+	const struct mem_dirty_layout *layout = &dirty_layout[area];
+	uint16_t nb = (layout->end - layout->start) >> layout->shift;
+
+	for (uint16_t i = 0; i < nb; i++)
+		mem_dirty_set(gb, area, i);
+}
+
+// VRAM and OAM are written through the slow path to keep track of the
+// changes, the written value is compared first as games often rewrite the
+// same data
+static void mem_write_tracked(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	mem_dirty_area area;
+
+	if (gb->mem.memory[addr] == value)
+		return;
+	gb->mem.memory[addr] = value;
+
+	if (addr < 0x9800)
+		area = MEM_DIRTY_TILES;
+	else if (addr < 0xA000)
+		area = MEM_DIRTY_MAPS;
+	else if (addr < OAM_ADDR + OAM_SIZE)
+		area = MEM_DIRTY_OAM;
+	else
 		return;
 
-	if (cart.type == TYPE_MBC1 || cart.type == TYPE_MBC1_RAM ||
-	    cart.type == TYPE_MBC1_RAM_BATT) {
-		uint16_t offset;
-		uint16_t idx;
-		if (addr >= 0xA000 && addr < 0xBfff &&
-		    cart.RAM_banking_enable) {
-			offset = BANK_SIZE_RAM * cart.RAM_bank_active;
-			idx = addr - 0xA000;
-			cart.mem[offset + idx] = value;
-			return;
-		}
+	mem_dirty_set(gb, area,
+		      (addr - dirty_layout[area].start) >> dirty_layout[area].shift);
+}
 
-		if (addr >= 0x6000 && addr < 0x7fff) {
-			if (value && 0xFE)
-				cart.mode = MODE_MBC1_4_32;
-			else
-				cart.mode = MODE_MBC1_16_8;
-			return;
-		}
+int mem_dirty_test(struct gb *gb, mem_dirty_area area, uint16_t idx)
+{
+	return gb->mem.dirty[area][idx / 64] >> (idx % 64) & 1;
+}
 
-		if (addr >= 0x4000 && addr < 0x5fff) {
-			switch (cart.mode) {
-			case MODE_MBC1_16_8:
-				cart.ROM_bank_active =
-					(cart.ROM_bank_active & 0x1f) |
-					((value & 0x03) << 5);
-				break;
-			case MODE_MBC1_4_32:
-				cart.RAM_bank_active = value & 0x02;
-				break;
-			default:
-				printf("Invalid MBC1 mode while writing to [0x4000-0x5fff]\n");
-				exit(0);
-			}
-			return;
-		}
+int mem_dirty_any(struct gb *gb, mem_dirty_area area)
+{
+	const struct mem_dirty_layout *layout = &dirty_layout[area];
+	uint16_t nb = (layout->end - layout->start) >> layout->shift;
 
-		if (addr >= 0x2000 && addr < 0x2fff) {
-			uint8_t fixed_value;
-			// fix the unconsistant ROM bank mapping from original hardware
-			switch (value) {
-			case 0x00:
-			case 0x20:
-			case 0x40:
-			case 0x60:
-				fixed_value = value + 1;
-				break;
-			default:
-				fixed_value = value;
-			}
-			cart.ROM_bank_active = (cart.ROM_bank_active & 0x60) |
-					       (fixed_value & 0x1f);
-			return;
-		}
+	for (int i = 0; i < (nb + 63) / 64; i++)
+		if (gb->mem.dirty[area][i])
+			return 1;
+	return 0;
+}
 
-		if (addr <= 0x1fff) {
-			if (value == 0x0A)
-				cart.RAM_banking_enable = 1;
-			else if (value == 0x00)
-				cart.RAM_banking_enable = 0;
-			return;
-		}
+void mem_dirty_clear(struct gb *gb, mem_dirty_area area, uint16_t idx)
+{
+	gb->mem.dirty[area][idx / 64] &= ~(1ULL << (idx % 64));
+}
+
+void mem_dirty_clear_all(struct gb *gb, mem_dirty_area area)
+{
+	memset(gb->mem.dirty[area], 0, sizeof(gb->mem.dirty[area]));
+}
+
+static void mem_map_pages(struct gb *gb)
+{
+	// I/O registers, HRAM and IE (page 0xFF) always take the slow path
+	mem_map(gb, 0x00, 0x100, NULL, 0);
+	mem_map_ROM_banks(gb);
+	// VRAM and OAM writes are tracked for the GPU
+	mem_map(gb, 0x80, 0x20, gb->mem.memory + 0x8000, 0);	// VRAM
+	mem_map_RAM_bank(gb);
+	mem_map(gb, 0xC0, 0x20, gb->mem.memory + 0xC000, 1);	// WRAM
+	mem_map(gb, 0xE0, 0x1E, gb->mem.memory + 0xC000, 1);	// WRAM echo
+	mem_map(gb, 0xFE, 0x01, gb->mem.memory + 0xFE00, 0);	// OAM
+}
+
+static void mem_DMA_end(struct gb *gb, uint64_t deadline)
+{
+	uint8_t *src;
+
+	gb->mem.DMA_active = 0;
+	mem_map_pages(gb);
+
+	// nothing could change the source meanwhile, copy it all at once
+	src = gb->mem.read_page[gb->mem.memory[DMA]];
+	if (src) {
+		memcpy(&gb->mem.memory[OAM_ADDR], src, OAM_SIZE);
+	} else {
+		for (int i = 0; i < OAM_SIZE; i++)
+			gb->mem.memory[OAM_ADDR + i] =
+				mem_get_byte(gb, gb->mem.memory[DMA] << 8 | i);
 	}
+	mem_dirty_set_all(gb, MEM_DIRTY_OAM);
+}
 
-	switch (addr) {
-	case 0xDFE9: // WRAM
-		memory[addr] = value;
-		break;
+// During OAM DMA the CPU only reaches the 0xFF page (I/O registers and HRAM):
+// every other page is unmapped so that the slow path alone has to check it
+static void mem_DMA_start(struct gb *gb)
+{
+	if (!gb->mem.DMA_active) {
+		gb->mem.DMA_active = 1;
+		mem_map(gb, 0x00, 0xFF, NULL, 0);
+	}
 
-	case 0xFF00: // P1 input
-		tmp = memory[addr];
-		memory[addr] = (value & 0xF0) | (input_get() & 0x0F);
-		break;
+	// a new transfer restarts the current one
+	sched_schedule(gb, SCHED_DMA, sched_get_now(gb) + DMA_DURATION,
+		       mem_DMA_end);
+}
 
-	case 0xFFA6: // WRAM
-		memory[addr] = value;
+// 0x0000-0x1FFF on every MBC
+static void mem_MBC_RAM_enable(struct gb *gb, uint8_t value)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	cart->RAM_banking_enable = (value & 0x0F) == 0x0A;
+	// games enable the RAM to write to it, whose content is only saved
+	// when it may have changed
+	cart->RAM_dirty |= cart->RAM_banking_enable;
+}
+
+// banks beyond the ROM size wrap around
+static void mem_MBC_set_banks(struct gb *gb, uint16_t ROM_bank_low,
+			      uint16_t ROM_bank, uint8_t RAM_bank)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	cart->ROM_bank_low = ROM_bank_low % cart->ROM_bank_nb;
+	cart->ROM_bank_active = ROM_bank % cart->ROM_bank_nb;
+	cart->RAM_bank_active = cart->RAM_bank_nb ? RAM_bank % cart->RAM_bank_nb : 0;
+
+	mem_map_ROM_banks(gb);
+	mem_map_RAM_bank(gb);
+}
+
+static void mem_MBC0_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+}
+
+// MBC1 registers, mapped over the ROM
+static void mem_MBC1_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	switch (addr >> 13) {
+	case 0: // 0x0000-0x1FFF: RAM enable
+		mem_MBC_RAM_enable(gb, value);
 		break;
+	case 1: // 0x2000-0x3FFF: ROM bank, lower 5 bits
+		cart->bank_reg1 = value & 0x1F;
+		// bank 0 can not be selected, 0x20, 0x40 and 0x60 neither
+		if (!cart->bank_reg1)
+			cart->bank_reg1 = 1;
+		break;
+	case 2: // 0x4000-0x5FFF: ROM bank upper bits or RAM bank
+		cart->bank_reg2 = value & 0x03;
+		break;
+	case 3: // 0x6000-0x7FFF: banking mode
+		cart->mode = value & 0x01 ? MODE_MBC1_4_32 : MODE_MBC1_16_8;
+		break;
+	default: // disabled RAM
+		return;
+	}
+
+	if (cart->mode == MODE_MBC1_4_32)
+		mem_MBC_set_banks(gb, cart->bank_reg2 << 5,
+				  cart->bank_reg2 << 5 | cart->bank_reg1,
+				  cart->bank_reg2);
+	else
+		mem_MBC_set_banks(gb, 0, cart->bank_reg2 << 5 | cart->bank_reg1,
+				  0);
+}
+
+// MBC2 registers are selected by bit 8 of the address
+static void mem_MBC2_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	if (addr >= 0xA000) {
+		if (cart->RAM_banking_enable)
+			cart->RAM[addr & (MBC2_RAM_SIZE - 1)] = 0xF0 | value;
+		return;
+	}
+
+	if (addr >= 0x4000)
+		return;
+
+	if (!(addr & 0x100)) {
+		mem_MBC_RAM_enable(gb, value);
+	} else {
+		cart->bank_reg1 = value & 0x0F;
+		if (!cart->bank_reg1)
+			cart->bank_reg1 = 1;
+	}
+
+	mem_MBC_set_banks(gb, 0, cart->bank_reg1, 0);
+}
 
-	case 0xFF04: // DIV
-		memory[addr] = 0x0;
+static void mem_RTC_update(struct gb *gb)
+{
+	struct cartridge_rtc *rtc = &gb->mem.cart.rtc;
+	uint64_t now = sched_get_time(gb);
+
+	if (!rtc->halt) {
+		uint64_t cycles = rtc->cycles + now - rtc->last;
+
+		rtc->seconds += cycles / CPU_FREQ;
+		rtc->cycles = cycles % CPU_FREQ;
+		if (rtc->seconds >= RTC_DAYS_MAX * 86400) {
+			rtc->seconds %= RTC_DAYS_MAX * 86400;
+			rtc->carry = 1;
+		}
+	}
+	rtc->last = now;
+}
+
+static void mem_RTC_latch(struct gb *gb)
+{
+	struct cartridge_rtc *rtc = &gb->mem.cart.rtc;
+	uint64_t days;
+
+	mem_RTC_update(gb);
+	days = rtc->seconds / 86400;
+	rtc->latched[0] = rtc->seconds % 60;
+	rtc->latched[1] = rtc->seconds / 60 % 60;
+	rtc->latched[2] = rtc->seconds / 3600 % 24;
+	rtc->latched[3] = days & 0xFF;
+	rtc->latched[4] = (days >> 8) | rtc->halt << 6 | rtc->carry << 7;
+}
+
+static uint8_t mem_RTC_read(struct gb *gb)
+{
+	return gb->mem.cart.rtc.latched[gb->mem.cart.RTC_select - 0x08];
+}
+
+static void mem_RTC_write(struct gb *gb, uint8_t value)
+{
+	struct cartridge_rtc *rtc = &gb->mem.cart.rtc;
+	uint64_t s, m, h, d;
+
+	mem_RTC_update(gb);
+	s = rtc->seconds % 60;
+	m = rtc->seconds / 60 % 60;
+	h = rtc->seconds / 3600 % 24;
+	d = rtc->seconds / 86400;
+
+	switch (gb->mem.cart.RTC_select) {
+	case 0x08:
+		s = value % 60;
+		rtc->cycles = 0;
+		break;
+	case 0x09:
+		m = value % 60;
+		break;
+	case 0x0A:
+		h = value % 24;
+		break;
+	case 0x0B:
+		d = (d & 0x100) | value;
 		break;
+	case 0x0C:
+		d = (d & 0xFF) | (value & 0x01) << 8;
+		rtc->halt = (value >> 6) & 0x01;
+		rtc->carry = value >> 7;
+		break;
+	}
+
+	rtc->seconds = ((d * 24 + h) * 60 + m) * 60 + s;
+	rtc->latched[gb->mem.cart.RTC_select - 0x08] = value;
+}
 
-	case 0xFF46: // DMA
-		memory[addr] = value;
-		mem_OAM_copy(value);
+static void mem_MBC3_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	switch (addr >> 13) {
+	case 0: // 0x0000-0x1FFF: RAM and clock enable
+		mem_MBC_RAM_enable(gb, value);
+		break;
+	case 1: // 0x2000-0x3FFF: ROM bank
+		cart->bank_reg1 = value & 0x7F;
+		if (!cart->bank_reg1)
+			cart->bank_reg1 = 1;
 		break;
+	case 2: // 0x4000-0x5FFF: RAM bank or clock register
+		cart->bank_reg2 = value;
+		cart->RTC_select = cart->timer && value >= 0x08 &&
+				   value <= 0x0C ? value : 0;
+		break;
+	case 3: // 0x6000-0x7FFF: the clock is latched by writing 0 then 1
+		if (cart->timer && cart->rtc.latch == 0x00 && value == 0x01)
+			mem_RTC_latch(gb);
+		cart->rtc.latch = value;
+		return;
+	default: // clock register, or disabled RAM
+		if (cart->RAM_banking_enable && cart->RTC_select)
+			mem_RTC_write(gb, value);
+		return;
+	}
 
-	default:
-		memory[addr] = value;
+	mem_MBC_set_banks(gb, 0, cart->bank_reg1, cart->bank_reg2 & 0x03);
+}
+
+// MBC5 selects any of 512 ROM banks, bank 0 included
+static void mem_MBC5_write(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	struct cartridge_info *cart = &gb->mem.cart;
+
+	if (addr < 0x2000)
+		mem_MBC_RAM_enable(gb, value);
+	else if (addr < 0x3000)
+		cart->bank_reg1 = (cart->bank_reg1 & 0x100) | value;
+	else if (addr < 0x4000)
+		cart->bank_reg1 = (cart->bank_reg1 & 0xFF) | (value & 0x01) << 8;
+	else if (addr < 0x6000)
+		cart->bank_reg2 = value & 0x0F;
+	else
+		return;
+
+	mem_MBC_set_banks(gb, 0, cart->bank_reg1, cart->bank_reg2);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// I/O registers (0xFF00-0xFF7F)
+/////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t io_read_reg(struct gb *gb, uint16_t addr)
+{
+	return gb->mem.memory[addr];
+}
+
+static void io_write_reg(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	gb->mem.memory[addr] = value;
+}
+
+static void io_write_none(struct gb *gb, uint16_t addr, uint8_t value)
+{
+}
+
+static uint8_t io_read_P1(struct gb *gb, uint16_t addr)
+{
+	return 0xC0 | (gb->mem.memory[addr] & 0x3F);
+}
+
+static void io_write_P1(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	gb->mem.memory[addr] = (value & 0xF0) | (input_get(gb) & 0x0F);
+}
+
+static uint8_t io_read_DIV(struct gb *gb, uint16_t addr)
+{
+	return timer_get_DIV(gb);
+}
+
+static void io_write_DIV(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	timer_reset_DIV(gb);
+}
+
+static uint8_t io_read_TIMA(struct gb *gb, uint16_t addr)
+{
+	return timer_get_TIMA(gb);
+}
+
+static void io_write_TIMA(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	timer_set_TIMA(gb, value);
+}
+
+static uint8_t io_read_TMA(struct gb *gb, uint16_t addr)
+{
+	return timer_get_TMA(gb);
+}
+
+static void io_write_TMA(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	timer_set_TMA(gb, value);
+}
+
+static uint8_t io_read_TAC(struct gb *gb, uint16_t addr)
+{
+	return timer_get_TAC(gb);
+}
+
+static void io_write_TAC(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	timer_set_TAC(gb, value);
+}
+
+static uint8_t io_read_IF(struct gb *gb, uint16_t addr)
+{
+	return 0xE0 | gb->mem.memory[addr];
+}
+
+// mode and coincidence bits come from the GPU state
+static uint8_t io_read_STAT(struct gb *gb, uint16_t addr)
+{
+	uint8_t coincidence = gpu_get_line(gb) == gb->mem.memory[LYC];
+
+	return 0x80 | (gb->mem.memory[addr] & 0x78) | coincidence << 2 |
+	       gpu_get_mode(gb);
+}
+
+static void io_write_STAT(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	gb->mem.memory[addr] = value & 0x78;
+}
+
+static uint8_t io_read_LY(struct gb *gb, uint16_t addr)
+{
+	return gpu_get_line(gb);
+}
+
+static void io_write_palette(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	gb->mem.memory[addr] = value;
+	gpu_set_palette(gb, GPU_PALETTE_BG + addr - BGP, value);
+}
 
-		//if(addr >= 0x8000 && addr <= 0x9FFF) {
-		/*if(addr >= 0x9800 && addr < 0x9C00) {
-            printf("tilemap[0x%x] = 0x%x\n", addr, memory[addr]);
-            //set_force_log();
-        }*/
+static void io_write_DMA(struct gb *gb, uint16_t addr, uint8_t value)
+{
+	gb->mem.memory[addr] = value;
+	mem_DMA_start(gb);
+}
+
+// one handler per register, registers without side effect are plain memory
+static const struct mem_io_handler {
+	uint8_t (*read)(struct gb *gb, uint16_t addr);
+	void (*write)(struct gb *gb, uint16_t addr, uint8_t value);
+} io_handlers[0x80] = {
+	[0x00 ... 0x7F] = { io_read_reg, io_write_reg },
+	[P1 & 0x7F]	= { io_read_P1, io_write_P1 },
+	[DIV & 0x7F]	= { io_read_DIV, io_write_DIV },
+	[TIMA & 0x7F]	= { io_read_TIMA, io_write_TIMA },
+	[TMA & 0x7F]	= { io_read_TMA, io_write_TMA },
+	[TAC & 0x7F]	= { io_read_TAC, io_write_TAC },
+	[IF & 0x7F]	= { io_read_IF, io_write_reg },
+	[LCDC & 0x7F]	= { io_read_reg, io_write_reg },
+	[STAT & 0x7F]	= { io_read_STAT, io_write_STAT },
+	[LY & 0x7F]	= { io_read_LY, io_write_none },
+	[DMA & 0x7F]	= { io_read_reg, io_write_DMA },
+	[BGP & 0x7F]	= { io_read_reg, io_write_palette },
+	[OBP0 & 0x7F]	= { io_read_reg, io_write_palette },
+	[OBP1 & 0x7F]	= { io_read_reg, io_write_palette },
+};
+
+// 0xFF00 + offset, as accessed by LDH: HRAM and IE never go through the table
+uint8_t mem_get_high(struct gb *gb, uint8_t offset)
+{
+	if (offset >= 0x80)
+		return gb->mem.memory[0xFF00 | offset];
+
+	return io_handlers[offset].read(gb, 0xFF00 | offset);
+}
+
+void mem_set_high(struct gb *gb, uint8_t offset, uint8_t value)
+{
+	if (offset >= 0x80) {
+		gb->mem.memory[0xFF00 | offset] = value;
+		return;
 	}
+
+	io_handlers[offset].write(gb, 0xFF00 | offset, value);
 }
 
-void mem_fill(uint16_t addr, uint8_t *data, uint16_t size)
+// Accesses the page table can not serve: the 0xFF page, MBC registers and
+// disabled cartridge RAM
+static uint8_t mem_read_slow(struct gb *gb, uint16_t addr)
 {
-	memcpy(memory + addr, data, size);
+	if (addr >= 0xFF00)
+		return mem_get_high(gb, addr);
+
+	if (gb->mem.DMA_active)
+		return 0xFF;
+
+	// MBC3 clock, or disabled cartridge RAM
+	if (addr >= 0xA000 && addr < 0xC000) {
+		if (gb->mem.cart.RTC_select && gb->mem.cart.RAM_banking_enable)
+			return mem_RTC_read(gb);
+		return 0xFF;
+	}
+
+	return gb->mem.memory[addr];
 }
 
-void mem_DIV_increment(uint8_t opcode_duration)
+static void mem_write_slow(struct gb *gb, uint16_t addr, uint8_t value)
 {
-	memory[DIV] += opcode_duration / 4;
+	if (addr >= 0xFF00) {
+		mem_set_high(gb, addr, value);
+		return;
+	}
+
+	if (gb->mem.DMA_active)
+		return;
+
+	if (addr >= OAM_ADDR || (addr >= 0x8000 && addr < 0xA000)) {
+		mem_write_tracked(gb, addr, value);
+		return;
+	}
+
+	// Do no overwrite cartridge ROM, the MBC registers are there
+	if (addr < 0x8000 || (addr >= 0xA000 && addr < 0xC000)) {
+		if (gb->mem.cart.write)
+			gb->mem.cart.write(gb, addr, value);
+		return;
+	}
+
+	gb->mem.memory[addr] = value;
 }
 
-void mem_init()
+uint8_t mem_get_byte(struct gb *gb, uint16_t addr)
 {
-	memory[0xFF05] = 0x00;
-	memory[0xFF06] = 0x00;
-	memory[0xFF07] = 0x00;
-	memory[0xFF10] = 0x80;
-	memory[0xFF11] = 0xBF;
-	memory[0xFF12] = 0xF3;
-	memory[0xFF14] = 0xBF;
-	memory[0xFF16] = 0x3F;
-	memory[0xFF17] = 0x00;
-	memory[0xFF19] = 0xBF;
-	memory[0xFF1A] = 0x7F;
-	memory[0xFF1B] = 0xFF;
-	memory[0xFF1C] = 0x9F;
-	memory[0xFF1E] = 0xBF;
-	memory[0xFF20] = 0xFF;
-	memory[0xFF21] = 0x00;
-	memory[0xFF22] = 0x00;
-	memory[0xFF23] = 0xBF;
-	memory[0xFF24] = 0x77;
-	memory[0xFF25] = 0xF3;
-	memory[0xFF26] = 0xF1;
-	memory[0xFF40] = 0x91;
-	memory[0xFF42] = 0x00;
-	memory[0xFF43] = 0x00;
-	memory[0xFF45] = 0x00;
-	memory[0xFF47] = 0xFC;
-	memory[0xFF48] = 0xFF;
-	memory[0xFF49] = 0xFF;
-	memory[0xFF4A] = 0x00;
-	memory[0xFF4B] = 0x00;
-	memory[0xFFFF] = 0x00;
+	uint8_t *page = gb->mem.read_page[addr >> 8];
+
+	if (page)
+		return page[addr & 0xFF];
+
+	return mem_read_slow(gb, addr);
 }
 
-int mem_load_rom(char *path)
+void mem_set_byte(struct gb *gb, uint16_t addr, uint8_t value)
 {
-	FILE *fd = fopen(path, "r");
-	if (fd == NULL) {
-		printf("failed to open ROM file\n");
-		return -EINVAL;
+	uint8_t *page = gb->mem.write_page[addr >> 8];
+
+	if (page) {
+		page[addr & 0xFF] = value;
+		return;
 	}
-	fseek(fd, 0, SEEK_END);
-	uint32_t rom_size = ftell(fd);
-	//printf("ROM size is %d kB\n", rom_size / 1024);
-	/*if (rom_size > (1024 * 32)) {
-		printf("ROM with size bigger than 32 kB aren't supported yet\n");
+
+	mem_write_slow(gb, addr, value);
+}
+
+// palettes written without going through their I/O handler
+static void mem_palettes_sync(struct gb *gb)
+{
+	for (uint16_t addr = BGP; addr <= OBP1; addr++)
+		gpu_set_palette(gb, GPU_PALETTE_BG + addr - BGP,
+				gb->mem.memory[addr]);
+}
+
+void mem_fill(struct gb *gb, uint16_t addr, uint8_t *data, uint16_t size)
+{
+	memcpy(gb->mem.memory + addr, data, size);
+	cpu_cache_flush(gb);
+	for (int i = 0; i < MEM_DIRTY_NB; i++)
+		mem_dirty_set_all(gb, i);
+	mem_palettes_sync(gb);
+}
+
+// ROM bank mapped at addr
+uint16_t mem_get_ROM_bank(struct gb *gb, uint16_t addr)
+{
+	if (addr < 0x4000)
+		return gb->mem.cart.ROM_bank_low;
+
+	return gb->mem.cart.ROM_bank_active;
+}
+
+void mem_init(struct gb *gb)
+{
+	mem_map_pages(gb);
+	// nothing is cached from VRAM and OAM yet
+	for (int i = 0; i < MEM_DIRTY_NB; i++)
+		mem_dirty_set_all(gb, i);
+
+	if (gb->mem.cart.RAM_mapped && gb->mem.save_interval > 0)
+		mem_save_event(gb, sched_get_time(gb));
+
+	gb->mem.memory[0xFF10] = 0x80;
+	gb->mem.memory[0xFF11] = 0xBF;
+	gb->mem.memory[0xFF12] = 0xF3;
+	gb->mem.memory[0xFF14] = 0xBF;
+	gb->mem.memory[0xFF16] = 0x3F;
+	gb->mem.memory[0xFF17] = 0x00;
+	gb->mem.memory[0xFF19] = 0xBF;
+	gb->mem.memory[0xFF1A] = 0x7F;
+	gb->mem.memory[0xFF1B] = 0xFF;
+	gb->mem.memory[0xFF1C] = 0x9F;
+	gb->mem.memory[0xFF1E] = 0xBF;
+	gb->mem.memory[0xFF20] = 0xFF;
+	gb->mem.memory[0xFF21] = 0x00;
+	gb->mem.memory[0xFF22] = 0x00;
+	gb->mem.memory[0xFF23] = 0xBF;
+	gb->mem.memory[0xFF24] = 0x77;
+	gb->mem.memory[0xFF25] = 0xF3;
+	gb->mem.memory[0xFF26] = 0xF1;
+	gb->mem.memory[0xFF40] = 0x91;
+	gb->mem.memory[0xFF42] = 0x00;
+	gb->mem.memory[0xFF43] = 0x00;
+	gb->mem.memory[0xFF45] = 0x00;
+	gb->mem.memory[0xFF47] = 0xFC;
+	gb->mem.memory[0xFF48] = 0xFF;
+	gb->mem.memory[0xFF49] = 0xFF;
+	gb->mem.memory[0xFF4A] = 0x00;
+	gb->mem.memory[0xFF4B] = 0x00;
+	gb->mem.memory[0xFFFF] = 0x00;
+	mem_palettes_sync(gb);
+}
+
+// Battery backed RAM is a shared mapping of <ROM name>.sav: the game writes
+// straight to the page cache, msync() only forces it to disk from time to time
+static int mem_load_save(struct gb *gb, char *rom_path)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	char *ext;
+	void *RAM;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s", rom_path);
+	ext = strrchr(path, '.');
+	if (!ext || strchr(ext, '/'))
+		ext = path + strlen(path);
+	snprintf(ext, sizeof(path) - (ext - path), ".sav");
+
+	// A save file may be longer than the RAM, like the ones of emulators
+	// appending the MBC3 clock to it: the end is kept, only the RAM is
+	// mapped. A new or shorter file is extended.
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0 || fstat(fd, &st) < 0 ||
+	    (st.st_size < gb->mem.cart.RAM_size &&
+	     ftruncate(fd, gb->mem.cart.RAM_size) < 0)) {
+		printf("failed to open save file '%s'\n", path);
+		if (fd >= 0)
+			close(fd);
 		return -EINVAL;
-	}*/
+	}
 
-	//uint8_t* buf = calloc(1, rom_size);
-	cart.mem = calloc(1, rom_size);
-	if (!cart.mem) {
-		printf("allocation failed\n");
+	RAM = mmap(NULL, gb->mem.cart.RAM_size, PROT_READ | PROT_WRITE,
+		   MAP_SHARED, fd, 0);
+	close(fd);
+	if (RAM == MAP_FAILED) {
+		printf("failed to map save file '%s'\n", path);
 		return -ENOMEM;
 	}
-	fseek(fd, 0, SEEK_SET);
-	fread(cart.mem, rom_size, 1, fd);
-	mem_fill(0, cart.mem, rom_size);
-	//free(buf);
-	fclose(fd);
+	gb->mem.cart.RAM = RAM;
+	gb->mem.cart.RAM_mapped = 1;
+	printf("Cartridge RAM saved to %s\n", path);
 
+	return 0;
+}
+
+int mem_load_rom(struct gb *gb, char *path)
+{
+	struct stat st;
+	void *rom;
+	int fd;
 
-	cart.RAM_banking_enable = 0;
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("failed to open ROM file\n");
+		return -EINVAL;
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size < 2 * BANK_SIZE_ROM) {
+		printf("ROM file too small\n");
+		close(fd);
+		return -EINVAL;
+	}
+
+	// The ROM is mapped read-only and read in place through the page table:
+	// pages are only loaded when the game reaches them, and every console
+	// running the same ROM shares the page cache copy
+	rom = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (rom == MAP_FAILED) {
+		printf("failed to map ROM file\n");
+		return -ENOMEM;
+	}
+	gb->mem.cart.mem = rom;
+	gb->mem.cart.ROM_size = st.st_size;
+	cpu_cache_flush(gb);
+
+
+	gb->mem.cart.ROM_bank_low = 0;
+	gb->mem.cart.ROM_bank_active = 1;
+	gb->mem.cart.bank_reg1 = 1;
+	gb->mem.cart.bank_reg2 = 0;
+	gb->mem.cart.mode = MODE_MBC0;
+	gb->mem.cart.RAM_bank_active = 0;
+	gb->mem.cart.RAM_banking_enable = 0;
+	gb->mem.cart.RTC_select = 0;
+	memset(&gb->mem.cart.rtc, 0, sizeof(gb->mem.cart.rtc));
 	// Check the cartridge type and act accordingly
-	printf("Cartridge type = %d\n", cart.mem[0x147]);
-	cart.type = cart.mem[0x147];
-	switch (cart.mem[0x147]) {
+	printf("Cartridge type = %d\n", gb->mem.cart.mem[0x147]);
+	gb->mem.cart.type = gb->mem.cart.mem[0x147];
+	gb->mem.cart.battery = 0;
+	gb->mem.cart.timer = 0;
+	switch (gb->mem.cart.type) {
+	case TYPE_MBC0_RAM_BATT:
+		gb->mem.cart.battery = 1;
 	case TYPE_MBC0:
+	case TYPE_MBC0_RAM:
+		gb->mem.cart.mbc = MBC_NONE;
+		gb->mem.cart.write = mem_MBC0_write;
+		// RAM without MBC is always enabled
+		gb->mem.cart.RAM_banking_enable = 1;
 		break;
+	case TYPE_MBC1_RAM_BATT:
+		gb->mem.cart.battery = 1;
 	case TYPE_MBC1:
 	case TYPE_MBC1_RAM:
-	case TYPE_MBC1_RAM_BATT:
+		gb->mem.cart.mbc = MBC_1;
+		gb->mem.cart.write = mem_MBC1_write;
+		gb->mem.cart.mode = MODE_MBC1_16_8;
+		break;
+	case TYPE_MBC2_BATT:
+		gb->mem.cart.battery = 1;
+	case TYPE_MBC2:
+		gb->mem.cart.mbc = MBC_2;
+		gb->mem.cart.write = mem_MBC2_write;
+		break;
+	case TYPE_MBC3_TIMER_BATT:
+	case TYPE_MBC3_TIMER_RAM_BATT:
+		gb->mem.cart.timer = 1;
+	case TYPE_MBC3_RAM_BATT:
+		gb->mem.cart.battery = 1;
+	case TYPE_MBC3:
+	case TYPE_MBC3_RAM:
+		gb->mem.cart.mbc = MBC_3;
+		gb->mem.cart.write = mem_MBC3_write;
+		break;
+	case TYPE_MBC5_RAM_BATT:
+	case TYPE_MBC5_RUMBLE_RAM_BATT:
+		gb->mem.cart.battery = 1;
+	case TYPE_MBC5:
+	case TYPE_MBC5_RAM:
+	case TYPE_MBC5_RUMBLE:
+	case TYPE_MBC5_RUMBLE_RAM:
+		gb->mem.cart.mbc = MBC_5;
+		gb->mem.cart.write = mem_MBC5_write;
 		break;
 	default:
-		printf("Cartridge type #%d not supported\n", cart.mem[0x147]);
-		exit(0);
+		printf("Cartridge type #%d not supported\n", gb->mem.cart.mem[0x147]);
+		return -EINVAL;
 	}
 
-	switch (cart.mem[0x148]) {
+	switch (gb->mem.cart.mem[0x148]) {
 	case 0:
-		cart.ROM_bank_nb = 2;
+		gb->mem.cart.ROM_bank_nb = 2;
 		break;
 	case 1:
-		cart.ROM_bank_nb = 4;
+		gb->mem.cart.ROM_bank_nb = 4;
 		break;
 	case 2:
-		cart.ROM_bank_nb = 8;
+		gb->mem.cart.ROM_bank_nb = 8;
 		break;
 	case 3:
-		cart.ROM_bank_nb = 16;
+		gb->mem.cart.ROM_bank_nb = 16;
 		break;
 	case 4:
-		cart.ROM_bank_nb = 32;
+		gb->mem.cart.ROM_bank_nb = 32;
 		break;
 	case 5:
-		cart.ROM_bank_nb = 64;
+		gb->mem.cart.ROM_bank_nb = 64;
 		break;
 	case 6:
-		cart.ROM_bank_nb = 128;
+		gb->mem.cart.ROM_bank_nb = 128;
+		break;
+	case 7:
+		gb->mem.cart.ROM_bank_nb = 256;
+		break;
+	case 8:
+		gb->mem.cart.ROM_bank_nb = 512;
 		break;
 	case 52:
-		cart.ROM_bank_nb = 72;
+		gb->mem.cart.ROM_bank_nb = 72;
 		break;
 	case 53:
-		cart.ROM_bank_nb = 80;
+		gb->mem.cart.ROM_bank_nb = 80;
 		break;
 	case 54:
-		cart.ROM_bank_nb = 96;
+		gb->mem.cart.ROM_bank_nb = 96;
 		break;
 	default:
 		printf("Cartridge invalid ROM bank number\n");
-		exit(0);
+		return -EINVAL;
 	}
-	printf("Cartridge ROM bank number = %d\n", cart.ROM_bank_nb);
+	printf("Cartridge ROM bank number = %d\n", gb->mem.cart.ROM_bank_nb);
 
-	switch (cart.mem[0x149]) {
+	if (gb->mem.cart.ROM_size < gb->mem.cart.ROM_bank_nb * BANK_SIZE_ROM) {
+		printf("ROM file truncated\n");
+		return -EINVAL;
+	}
+
+	switch (gb->mem.cart.mem[0x149]) {
 	case 0:
+		gb->mem.cart.RAM_bank_nb = 0;
+		break;
 	case 1:
 	case 2:
-		cart.RAM_bank_nb = 1;
+		gb->mem.cart.RAM_bank_nb = 1;
+		break;
+	case 3:
+		gb->mem.cart.RAM_bank_nb = 4;
 		break;
 	case 4:
-		cart.RAM_bank_nb = 16;
+		gb->mem.cart.RAM_bank_nb = 16;
+		break;
+	case 5:
+		gb->mem.cart.RAM_bank_nb = 8;
 		break;
 	default:
 		printf("Cartridge invalid RAM bank number\n");
-		exit(0);
+		return -EINVAL;
 	}
-	printf("Cartridge RAM bank number = %d\n", cart.RAM_bank_nb);
+	printf("Cartridge RAM bank number = %d\n", gb->mem.cart.RAM_bank_nb);
 
+	gb->mem.cart.RAM_size = gb->mem.cart.RAM_bank_nb * BANK_SIZE_RAM;
+	// MBC2 has its own RAM, whatever the header says
+	if (gb->mem.cart.mbc == MBC_2)
+		gb->mem.cart.RAM_size = MBC2_RAM_SIZE;
+	if (!gb->mem.cart.RAM_size)
+		return 0;
 
+	if (gb->mem.cart.battery && gb->mem.save_interval != MEM_SAVE_NONE)
+		return mem_load_save(gb, path);
 
-	// TODO: write a exit function which will free cart and other ressources
+	gb->mem.cart.RAM = calloc(1, gb->mem.cart.RAM_size);
+	if (!gb->mem.cart.RAM) {
+		printf("allocation failed\n");
+		return -ENOMEM;
+	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+void mem_save_flush(struct gb *gb)
+{
+	if (!gb->mem.cart.RAM_mapped || !gb->mem.cart.RAM_dirty)
+		return;
+
+	msync(gb->mem.cart.RAM, gb->mem.cart.RAM_size, MS_SYNC);
+
+	// the game may still be writing while the RAM is enabled
+	gb->mem.cart.RAM_dirty = gb->mem.cart.RAM_banking_enable;
+}
+
+static void mem_save_event(struct gb *gb, uint64_t deadline)
+{
+	mem_save_flush(gb);
+	sched_schedule(gb, SCHED_SAVE,
+		       deadline + (uint64_t)gb->mem.save_interval * CPU_FREQ / 1000,
+		       mem_save_event);
+}
+
+// in ms of emulated time, 0 to save only on exit, MEM_SAVE_NONE to never
+// write the cartridge RAM to disk
+void mem_set_save_interval(struct gb *gb, int32_t interval)
+{
+	gb->mem.save_interval = interval;
+}
+
+void mem_release(struct gb *gb)
+{
+	if (gb->mem.cart.mem)
+		munmap(gb->mem.cart.mem, gb->mem.cart.ROM_size);
+	gb->mem.cart.mem = NULL;
+	if (gb->mem.cart.RAM_mapped) {
+		gb->mem.cart.RAM_dirty = 1;
+		mem_save_flush(gb);
+		munmap(gb->mem.cart.RAM, gb->mem.cart.RAM_size);
+	} else {
+		free(gb->mem.cart.RAM);
+	}
+	gb->mem.cart.RAM = NULL;
+	gb->mem.cart.RAM_mapped = 0;
+}
@@ -7,58 +7,161 @@
 #include <inttypes.h>
 
 #define MEMORY_SIZE 0x10000
+#define MEM_PAGE_SIZE 0x100
 #define OAM_ADDR    0xFE00
+#define OAM_SIZE    0xA0
 
 #define BANK_SIZE_ROM   16384   //16kB
-#define BANK_SIZE_RAM   2048    //2kB      
+#define BANK_SIZE_RAM   8192    //8kB
+
+#define MEM_SAVE_INTERVAL_DEFAULT   1000    // ms
+#define MEM_SAVE_NONE               -1
+
+#define DMA_DURATION    640     // cycles, 160 bytes at 1 byte per M-cycle
 
 // I/O registers addr shortcuts
 
 #define P1      0xFF00
 #define DIV     0xFF04
+#define TIMA    0xFF05
+#define TMA     0xFF06
+#define TAC     0xFF07
 
 #define LCDC    0xFF40
+#define STAT    0xFF41
 #define SCY     0xFF42
 #define SCX     0xFF43
 #define LY      0xFF44
 #define LYC     0xFF45
+#define DMA     0xFF46
+#define BGP     0xFF47
+#define OBP0    0xFF48
+#define OBP1    0xFF49
 
 #define IF      0xFF0F
 #define IE      0xFFFF
 
+struct gb;
+
+// cartridge type, as found in the ROM header
 typedef enum {
     TYPE_MBC0 = 0,
     TYPE_MBC1 = 1, 
     TYPE_MBC1_RAM = 2, 
     TYPE_MBC1_RAM_BATT = 3, 
+    TYPE_MBC2 = 5,
+    TYPE_MBC2_BATT = 6,
+    TYPE_MBC0_RAM = 8,
+    TYPE_MBC0_RAM_BATT = 9,
+    TYPE_MBC3_TIMER_BATT = 0x0F,
+    TYPE_MBC3_TIMER_RAM_BATT = 0x10,
+    TYPE_MBC3 = 0x11,
+    TYPE_MBC3_RAM = 0x12,
+    TYPE_MBC3_RAM_BATT = 0x13,
+    TYPE_MBC5 = 0x19,
+    TYPE_MBC5_RAM = 0x1A,
+    TYPE_MBC5_RAM_BATT = 0x1B,
+    TYPE_MBC5_RUMBLE = 0x1C,
+    TYPE_MBC5_RUMBLE_RAM = 0x1D,
+    TYPE_MBC5_RUMBLE_RAM_BATT = 0x1E,
 } memory_cart_type;
 
+typedef enum {
+    MBC_NONE,
+    MBC_1,
+    MBC_2,
+    MBC_3,
+    MBC_5,
+} memory_cart_mbc;
+
+// VRAM and OAM areas whose writes are tracked for the GPU caches
+typedef enum {
+    MEM_DIRTY_TILES,            // 0x8000-0x97FF, one bit per 16 bytes tile
+    MEM_DIRTY_MAPS,             // 0x9800-0x9FFF, one bit per tile map entry
+    MEM_DIRTY_OAM,              // 0xFE00-0xFE9F, one bit per 4 bytes sprite
+    MEM_DIRTY_NB,
+} mem_dirty_area;
+
+#define MEM_DIRTY_BITS_MAX  2048    // entries of both tile maps
+
 typedef enum {
     MODE_MBC0,
     MODE_MBC1_16_8, 
     MODE_MBC1_4_32, 
 } memory_cart_mode;
 
+#define MBC2_RAM_SIZE   512     // 4 bits values
+#define RTC_DAYS_MAX    512
+
+// MBC3 real time clock, counting emulated time so that sessions stay
+// deterministic
+struct cartridge_rtc {
+    uint64_t seconds;           // since day 0, below 512 days
+    uint64_t last;              // cycle of the last update
+    uint32_t cycles;            // fraction of the current second
+    uint8_t halt;
+    uint8_t carry;              // day counter overflow
+    uint8_t latch;              // last value written to the latch register
+    uint8_t latched[5];         // S, M, H, DL, DH as read by the game
+};
+
 
 struct cartridge_info {
-    uint8_t *mem;
+    uint8_t *mem;               // read-only mapping of the ROM file
+    uint32_t ROM_size;
+    uint8_t *RAM;
+    uint32_t RAM_size;
+    uint8_t RAM_mapped;         // RAM is the mapping of the save file
+    uint8_t RAM_dirty;          // may differ from the save file on disk
+    uint8_t battery;
+    uint8_t timer;
     memory_cart_type type;
+    memory_cart_mbc mbc;
     memory_cart_mode mode;
-    uint8_t ROM_bank_nb;
-    uint8_t ROM_bank_active;
+    uint16_t ROM_bank_nb;
+    uint16_t ROM_bank_low;      // mapped at 0x0000-0x3FFF
+    uint16_t ROM_bank_active;   // mapped at 0x4000-0x7FFF
     uint8_t RAM_bank_nb;
     uint8_t RAM_bank_active;
     uint8_t RAM_banking_enable;
+    uint16_t bank_reg1;         // MBC bank registers as written by the game
+    uint8_t bank_reg2;
+    uint8_t RTC_select;         // MBC3 clock register mapped instead of RAM
+    struct cartridge_rtc rtc;
+
+    // writes to the MBC registers and to the RAM when it is not mapped
+    void (*write)(struct gb *gb, uint16_t addr, uint8_t value);
 };
 
+struct mem_context {
+    uint8_t memory[MEMORY_SIZE];
+    struct cartridge_info cart;
+    int32_t save_interval;      // ms of emulated time between RAM saves
+    uint8_t DMA_active;         // OAM DMA running, the CPU only reaches 0xFFxx
+    uint64_t dirty[MEM_DIRTY_NB][MEM_DIRTY_BITS_MAX / 64];
+
+    // page table: host address of each 256 bytes guest page, NULL when the
+    // accesses to the page need the slow path (MBC and I/O registers)
+    uint8_t *read_page[MEMORY_SIZE / MEM_PAGE_SIZE];
+    uint8_t *write_page[MEMORY_SIZE / MEM_PAGE_SIZE];
+};
 
-uint8_t mem_get_byte(uint16_t addr);
-void mem_set_byte(uint16_t addr, uint8_t value);
-void mem_fill(uint16_t addr, uint8_t *data, uint16_t size);
-void mem_DIV_increment(uint8_t opcode_duration);
-void mem_init();
-int mem_load_rom(char* path);
+uint8_t mem_get_byte(struct gb *gb, uint16_t addr);
+void mem_set_byte(struct gb *gb, uint16_t addr, uint8_t value);
+uint8_t mem_get_high(struct gb *gb, uint8_t offset);
+void mem_set_high(struct gb *gb, uint8_t offset, uint8_t value);
+void mem_fill(struct gb *gb, uint16_t addr, uint8_t *data, uint16_t size);
+uint16_t mem_get_ROM_bank(struct gb *gb, uint16_t addr);
+void mem_init(struct gb *gb);
+int mem_load_rom(struct gb *gb, char* path);
+void mem_release(struct gb *gb);
+void mem_save_flush(struct gb *gb);
+void mem_set_save_interval(struct gb *gb, int32_t interval);
+int mem_dirty_test(struct gb *gb, mem_dirty_area area, uint16_t idx);
+int mem_dirty_any(struct gb *gb, mem_dirty_area area);
+void mem_dirty_clear(struct gb *gb, mem_dirty_area area, uint16_t idx);
+void mem_dirty_clear_all(struct gb *gb, mem_dirty_area area);
 
-int dump_VRAM();
+int dump_VRAM(struct gb *gb);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "gb.h"
+#include "sched.h"
+
+void sched_init(struct gb *gb)
+{
+	memset(gb->sched.events, 0, sizeof(gb->sched.events));
+	gb->sched.queue = NULL;
+	gb->sched.time = 0;
+}
+
+uint64_t sched_get_time(struct gb *gb)
+{
+	return gb->sched.time;
+}
+
+// Cycle of the current access: the CPU may be in the middle of a run not
+// accounted by sched_advance() yet
+uint64_t sched_get_now(struct gb *gb)
+{
+	return gb->sched.time + cpu_get_cycles_run(gb);
+}
+
+uint32_t sched_get_cycles_to_event(struct gb *gb)
+{
+	if (!gb->sched.queue)
+		return SCHED_MAX_SLICE;
+
+	if (gb->sched.queue->deadline <= gb->sched.time)
+		return 0;
+
+	if (gb->sched.queue->deadline - gb->sched.time > SCHED_MAX_SLICE)
+		return SCHED_MAX_SLICE;
+
+	return gb->sched.queue->deadline - gb->sched.time;
+}
+
+void sched_cancel(struct gb *gb, sched_event_id id)
+{
+	struct sched_event **p = &gb->sched.queue;
+
+	if (!gb->sched.events[id].pending)
+		return;
+
+	while (*p != &gb->sched.events[id])
+		p = &(*p)->next;
+
+	*p = gb->sched.events[id].next;
+	gb->sched.events[id].pending = 0;
+}
+
+void sched_schedule(struct gb *gb, sched_event_id id, uint64_t deadline,
+		    sched_callback callback)
+{
+	struct sched_event *event = &gb->sched.events[id];
+	struct sched_event **p = &gb->sched.queue;
+
+	sched_cancel(gb, id);
+
+	// events due at the same cycle run in the order they were scheduled
+	while (*p && (*p)->deadline <= deadline)
+		p = &(*p)->next;
+
+	event->deadline = deadline;
+	event->callback = callback;
+	event->next = *p;
+	event->pending = 1;
+	*p = event;
+
+	// scheduled by the CPU, before the end of its current run
+	if (gb->sched.queue == event)
+		cpu_limit_run(gb, sched_get_cycles_to_event(gb));
+}
+
+void sched_advance(struct gb *gb, uint32_t cycles)
+{
+	gb->sched.time += cycles;
+
+	// a callback may schedule its next occurrence already due
+	while (gb->sched.queue && gb->sched.queue->deadline <= gb->sched.time) {
+		struct sched_event *event = gb->sched.queue;
+
+		gb->sched.queue = event->next;
+		event->pending = 0;
+		event->callback(gb, event->deadline);
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+struct gb;
+
+// Upper bound of a CPU run when no event is pending, one frame
+#define SCHED_MAX_SLICE 70224
+
+typedef enum {
+    SCHED_GPU,
+    SCHED_SAVE,
+    SCHED_DMA,
+    SCHED_TIMER,
+    SCHED_EVENT_NB,
+} sched_event_id;
+
+// called with the cycle at which the event was due
+typedef void (*sched_callback)(struct gb *gb, uint64_t deadline);
+
+// Hardware events are kept in a list sorted by deadline: the CPU only has to
+// run until the first one, then every event due is processed in order.
+// There is a single instance of each event, scheduling it again moves it.
+struct sched_event {
+    uint64_t deadline;
+    sched_callback callback;
+    struct sched_event *next;
+    uint8_t pending;
+};
+
+struct sched_context {
+    struct sched_event events[SCHED_EVENT_NB];
+    struct sched_event *queue;
+    // clock cycles elapsed since power on
+    uint64_t time;
+};
+
+void sched_init(struct gb *gb);
+uint64_t sched_get_time(struct gb *gb);
+uint64_t sched_get_now(struct gb *gb);
+uint32_t sched_get_cycles_to_event(struct gb *gb);
+void sched_schedule(struct gb *gb, sched_event_id id, uint64_t deadline,
+                    sched_callback callback);
+void sched_cancel(struct gb *gb, sched_event_id id);
+void sched_advance(struct gb *gb, uint32_t cycles);
+
+#endif
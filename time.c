@@ -1,24 +1,31 @@
 #include <SDL2/SDL.h>
 
+#include "gb.h"
+
 #define SCREEN_FPS 60
 #define MS_PER_SEC 1000
 
 const int SCREEN_TICKS_PER_FRAME = MS_PER_SEC / SCREEN_FPS;
 
-static Uint32 start_ticks = 0;
-
-void time_init()
+void time_init(struct gb *gb)
 {
-    start_ticks = SDL_GetTicks();
+    gb->time.start_ticks = SDL_GetTicks();
 }
 
-void time_regulate_framerate()
+void time_regulate_framerate(struct gb *gb)
 {
 
-    int frame_ticks = SDL_GetTicks() - start_ticks;
+    int frame_ticks = SDL_GetTicks() - gb->time.start_ticks;
 	if (frame_ticks < SCREEN_TICKS_PER_FRAME)
 		SDL_Delay(SCREEN_TICKS_PER_FRAME - frame_ticks);
 
-	start_ticks = SDL_GetTicks();
+	gb->time.start_ticks = SDL_GetTicks();
+
+}
 
-}
\ No newline at end of file
+// Nothing to emulate, wait for the host instead of spinning
+void time_idle(struct gb *gb)
+{
+	SDL_Delay(SCREEN_TICKS_PER_FRAME);
+	gb->time.start_ticks = SDL_GetTicks();
+}
@@ -1,5 +1,16 @@
+#ifndef TIME_H
+#define TIME_H
 
+#include <stdint.h>
 
+struct gb;
 
-void time_init();
-void time_regulate_framerate();
\ No newline at end of file
+struct time_context {
+    uint32_t start_ticks;
+};
+
+void time_init(struct gb *gb);
+void time_regulate_framerate(struct gb *gb);
+void time_idle(struct gb *gb);
+
+#endif
@@ -0,0 +1,131 @@
+#include "gb.h"
+
+#define TAC_ENABLE  0x04
+
+// log2 of the TIMA period in cycles, for each TAC clock select
+static const uint8_t TIMA_shift[4] = { 10, 4, 6, 8 };
+
+static uint16_t timer_get_counter(struct gb *gb, uint64_t now)
+{
+	return now + gb->timer.offset;
+}
+
+// Count the TIMA increments since the last update, reloading it from TMA
+// and requesting an interrupt on overflow
+static void timer_update(struct gb *gb, uint64_t now)
+{
+	struct timer_context *timer = &gb->timer;
+	uint8_t shift = TIMA_shift[timer->tac & 0x03];
+	uint32_t tima;
+
+	if (timer->tac & TAC_ENABLE) {
+		tima = timer->tima + ((now + timer->offset) >> shift) -
+		       ((timer->last + timer->offset) >> shift);
+		while (tima > 0xFF) {
+			tima = timer->tma + tima - 0x100;
+			mem_set_byte(gb, IF, mem_get_byte(gb, IF) | INT_TIMER);
+		}
+		timer->tima = tima;
+	}
+	timer->last = now;
+}
+
+static void timer_overflow_event(struct gb *gb, uint64_t deadline);
+
+// to be called after each change of the timer state
+static void timer_schedule(struct gb *gb)
+{
+	struct timer_context *timer = &gb->timer;
+	uint8_t shift = TIMA_shift[timer->tac & 0x03];
+	uint64_t overflow;
+
+	if (!(timer->tac & TAC_ENABLE)) {
+		sched_cancel(gb, SCHED_TIMER);
+		return;
+	}
+
+	// cycle of the (0x100 - TIMA)th falling edge from now on
+	overflow = (((timer->last + timer->offset) >> shift) + 0x100 -
+		    timer->tima) << shift;
+	sched_schedule(gb, SCHED_TIMER, overflow - timer->offset,
+		       timer_overflow_event);
+}
+
+static void timer_overflow_event(struct gb *gb, uint64_t deadline)
+{
+	timer_update(gb, deadline);
+	timer_schedule(gb);
+}
+
+uint8_t timer_get_DIV(struct gb *gb)
+{
+	return timer_get_counter(gb, sched_get_now(gb)) >> 8;
+}
+
+// Any write clears the whole counter, which may be a falling edge for TIMA
+void timer_reset_DIV(struct gb *gb)
+{
+	struct timer_context *timer = &gb->timer;
+	uint64_t now = sched_get_now(gb);
+	uint8_t shift = TIMA_shift[timer->tac & 0x03];
+
+	timer_update(gb, now);
+	// the selected bit drops now instead of at the end of its period
+	if (timer->tac & TAC_ENABLE &&
+	    timer_get_counter(gb, now) & 1 << (shift - 1))
+		timer_update(gb, now + (1 << (shift - 1)));
+
+	timer->offset = -now;
+	timer->last = now;
+	timer_schedule(gb);
+}
+
+uint8_t timer_get_TIMA(struct gb *gb)
+{
+	timer_update(gb, sched_get_now(gb));
+	return gb->timer.tima;
+}
+
+void timer_set_TIMA(struct gb *gb, uint8_t value)
+{
+	timer_update(gb, sched_get_now(gb));
+	gb->timer.tima = value;
+	timer_schedule(gb);
+}
+
+uint8_t timer_get_TMA(struct gb *gb)
+{
+	return gb->timer.tma;
+}
+
+void timer_set_TMA(struct gb *gb, uint8_t value)
+{
+	// increments up to now reload with the former value
+	timer_update(gb, sched_get_now(gb));
+	gb->timer.tma = value;
+}
+
+uint8_t timer_get_TAC(struct gb *gb)
+{
+	return 0xF8 | gb->timer.tac;
+}
+
+void timer_set_TAC(struct gb *gb, uint8_t value)
+{
+	timer_update(gb, sched_get_now(gb));
+	gb->timer.tac = value & 0x07;
+	timer_schedule(gb);
+}
+
+// state left by the boot ROM
+void timer_init(struct gb *gb)
+{
+	uint64_t now = sched_get_time(gb);
+
+	gb->timer.offset = 0xABCC - now;
+	gb->timer.last = now;
+	gb->timer.tima = 0x00;
+	gb->timer.tma = 0x00;
+	gb->timer.tac = 0x00;
+	timer_schedule(gb);
+}
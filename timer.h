@@ -0,0 +1,30 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+struct gb;
+
+// DIV is the upper byte of a 16 bits counter incremented at each clock cycle,
+// TIMA counts the falling edges of one of its bits. Neither is ticked: both
+// are computed from the current cycle when read, and only the TIMA overflow is
+// scheduled.
+struct timer_context {
+    uint16_t offset;            // counter value = current cycle + offset
+    uint64_t last;              // cycle TIMA was last brought up to date
+    uint8_t tima;
+    uint8_t tma;
+    uint8_t tac;
+};
+
+uint8_t timer_get_DIV(struct gb *gb);
+void timer_reset_DIV(struct gb *gb);
+uint8_t timer_get_TIMA(struct gb *gb);
+void timer_set_TIMA(struct gb *gb, uint8_t value);
+uint8_t timer_get_TMA(struct gb *gb);
+void timer_set_TMA(struct gb *gb, uint8_t value);
+uint8_t timer_get_TAC(struct gb *gb);
+void timer_set_TAC(struct gb *gb, uint8_t value);
+void timer_init(struct gb *gb);
+
+#endif
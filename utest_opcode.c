@@ -1,8 +1,11 @@
 #include <errno.h>
 #include <stdlib.h>
 #include "cpu.h"
+#include "gb.h"
 #include "memory.h"
 
+static struct gb *gb;
+
 struct opcode_info {
 	uint8_t code;
 	const char *name;
@@ -20,7 +23,7 @@ struct opcode_info opcode_dict[] = {
 	{.code = 0x05, .name = "DEC B", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0x06, .name = "LD B,d8", .byte1 = 0x42, .byte2 = 0x00 },
 	{.code = 0x07, .name = "RLC A", .byte1 = 0x00, .byte2 = 0x00 },
-	{.code = 0x08, .name = "LD (a16),SP", .byte1 = 0x34, .byte2 = 0x12 },
+	{.code = 0x08, .name = "LD (a16),SP", .byte1 = 0x34, .byte2 = 0xC2 },
 	{.code = 0x09, .name = "ADD HL,BC", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0x0A, .name = "LD A,(BC)", .byte1 = 0x00, .byte2 = 0x42 },
 	{.code = 0x0B, .name = "DEC BC", .byte1 = 0x00, .byte2 = 0x00 },
@@ -263,7 +266,7 @@ struct opcode_info opcode_dict[] = {
 	{.code = 0xE7, .name = "RST 20h", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xE8, .name = "ADD SP,r8", .byte1 = 0x05, .byte2 = 0x00 },
 	{.code = 0xE9, .name = "JP (HL)", .byte1 = 0x00, .byte2 = 0x00 },
-	{.code = 0xEA, .name = "LD (a16),A", .byte1 = 0x86, .byte2 = 0x54 },
+	{.code = 0xEA, .name = "LD (a16),A", .byte1 = 0x86, .byte2 = 0xC4 },
 	{.code = 0xEB, .name = "NA", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xEC, .name = "NA", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xED, .name = "NA", .byte1 = 0x00, .byte2 = 0x00 },
@@ -280,7 +283,7 @@ struct opcode_info opcode_dict[] = {
 	{.code = 0xF7, .name = "RST 30h", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xF8, .name = "LD HL,SP+r8", .byte1 = 0x55, .byte2 = 0x00 },
 	{.code = 0xF9, .name = "LD SP,HL", .byte1 = 0x00, .byte2 = 0x00 },
-	{.code = 0xFA, .name = "LD A,(a16)", .byte1 = 0x51, .byte2 = 0x15 },
+	{.code = 0xFA, .name = "LD A,(a16)", .byte1 = 0x51, .byte2 = 0xC5 },
 	{.code = 0xFB, .name = "EI (no test)", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xFC, .name = "NA", .byte1 = 0x00, .byte2 = 0x00 },
 	{.code = 0xFD, .name = "NA", .byte1 = 0x00, .byte2 = 0x00 },
@@ -291,24 +294,27 @@ struct opcode_info opcode_dict[] = {
 
 static int cpu_test_opcode(struct opcode_info op_info)
 {
-	mem_set_byte(cpu_get_PC() + 0, op_info.code);
-	mem_set_byte(cpu_get_PC() + 1, op_info.byte1);
-	mem_set_byte(cpu_get_PC() + 2, op_info.byte2);
+	uint8_t code[3] = { op_info.code, op_info.byte1, op_info.byte2 };
+	uint8_t length, duration;
+
+	// the instruction is mostly in ROM, which the CPU can't write
+	mem_fill(gb, cpu_get_PC(gb), code, sizeof(code));
 	printf("\n");
-	return cpu_exec_opcode(mem_get_byte(cpu_get_PC()));
+	cpu_exec_opcode(gb, &length, &duration);
+	return length;
 }
 
 static int cpu_print_registers()
 {
 	printf("[REGS]  A=0x%X,      B=0x%X,    C=0x%X,    D=0x%X,    E=0x%X,    F=0x%X,    H=0x%X,    L=0x%X\n",
-	       cpu_get_A(), cpu_get_B(), cpu_get_C(), cpu_get_D(), cpu_get_E(),
-	       cpu_get_F(), cpu_get_H(), cpu_get_H());
+	       cpu_get_A(gb), cpu_get_B(gb), cpu_get_C(gb), cpu_get_D(gb), cpu_get_E(gb),
+	       cpu_get_F(gb), cpu_get_H(gb), cpu_get_H(gb));
 	printf("[REGS]  AF=0x%04x,  BC=0x%04x, DE=0x%04x, HL=0x%04x, PC=0x%04x, SP=0x%04x\n",
-	       cpu_get_AF(), cpu_get_BC(), cpu_get_DE(), cpu_get_HL(),
-	       cpu_get_PC(), cpu_get_SP());
+	       cpu_get_AF(gb), cpu_get_BC(gb), cpu_get_DE(gb), cpu_get_HL(gb),
+	       cpu_get_PC(gb), cpu_get_SP(gb));
 	printf("[FLAGS] ZERO=%d,     SUB=%d,     HCARRY=%d,  CARRY=%d\n",
-	       cpu_get_F() >> 7, (cpu_get_F() & 0x40) >> 6,
-	       (cpu_get_F() & 0x20) >> 5, (cpu_get_F() & 0x10) >> 4);
+	       cpu_get_F(gb) >> 7, (cpu_get_F(gb) & 0x40) >> 6,
+	       (cpu_get_F(gb) & 0x20) >> 5, (cpu_get_F(gb) & 0x10) >> 4);
 
 	return 0;
 }
@@ -322,7 +328,7 @@ static int cpu_print_test_result(struct opcode_info op_info,
 		printf("[ERROR] OPCODE 0x%X '%s' failed\n", op_info.code,
 		       op_info.name);
 		printf("!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
-		exit(0);
+		exit(1);
 	} else {
 		cpu_print_registers();
 		printf("[SUCCESS] OPCODE 0x%X '%s' OK\n", op_info.code,
@@ -338,2609 +344,2600 @@ int testsuite_opcodes()
 	uint8_t lg = 0;
 	uint8_t opcode = 0x00;
 	uint16_t u16;
-	cpu_reset_registers();
-	void cpu_reset_registers();
+	cpu_reset_registers(gb);
+	void cpu_reset_registers(struct gb *gb);
 	memset(memfull, 0, 8000);
 
 	// 0x00 : NOP
 	opcode = 0x00;
-	lg = cpu_exec_opcode(mem_get_byte(0));
+	lg = cpu_test_opcode(opcode_dict[opcode]);
 
 	// 0x01 : LD BC,d16
 	opcode = 0x01;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC() == 0x4321);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC(gb) == 0x4321);
 
 	// 0x02 : LD (BC),A
 	opcode = 0x02;
-	cpu_reset_registers();
-	cpu_set_A(0x42);
-	cpu_set_BC(0x3333);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x42);
+	cpu_set_BC(gb, 0xC333);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(0x3333) == 0x0042);
+			      mem_get_byte(gb, 0xC333) == 0x0042);
 
 	// 0x03 : INC BC
 	opcode = 0x03;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC() == 0x0001);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC(gb) == 0x0001);
 
 	// 0x04 : INC B
 	opcode = 0x04;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0x01);
-	cpu_set_B(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0x01);
+	cpu_set_B(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0x00);
 
 	// 0x05 : DEC B
 	opcode = 0x05;
-	cpu_reset_registers();
-	cpu_set_B(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xFF);
 
 	// 0x06 : LD B,d8
 	opcode = 0x06;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0x42);
 
 	// 0x07 : RLC A
 	opcode = 0x07;
-	cpu_reset_registers();
-	cpu_set_A(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x02);
-	cpu_set_A(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x02);
+	cpu_set_A(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x10);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x10);
 
 	// 0x08: LD (a16),SP
 	opcode = 0x08;
-	cpu_reset_registers();
-	cpu_set_SP(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xABCD);
 	//memcpy(memfull, mem, 3);
 	cpu_test_opcode(opcode_dict[opcode]);
-	printf("memfull[0x1234] = 0x%x\n", mem_get_byte(0x1234));
+	printf("memfull[0xC234] = 0x%x\n", mem_get_byte(gb, 0xC234));
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(0x1234) == 0xCD &&
-				      mem_get_byte(0x1235) == 0xAB);
+			      mem_get_byte(gb, 0xC234) == 0xCD &&
+				      mem_get_byte(gb, 0xC235) == 0xAB);
 
 	// 0x09: ADD HL,BC
 	opcode = 0x09;
-	cpu_reset_registers();
-	cpu_set_HL(0x1111);
-	cpu_set_BC(0x2222);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x1111);
+	cpu_set_BC(gb, 0x2222);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x3333);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x3333);
 	// test carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0xF000);
-	cpu_set_BC(0x2222);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xF000);
+	cpu_set_BC(gb, 0x2222);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x1222 && cpu_get_F() == 0x10);
+			      cpu_get_HL(gb) == 0x1222 && cpu_get_F(gb) == 0x10);
 	// test half carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0x00FF);
-	cpu_set_BC(0x0001);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x00FF);
+	cpu_set_BC(gb, 0x0001);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x0100 && cpu_get_F() == 0x20);
+			      cpu_get_HL(gb) == 0x0100 && cpu_get_F(gb) == 0x20);
 
 	// 0x0A: LD LD A,(BC)
 	opcode = 0x0A;
-	cpu_reset_registers();
-	cpu_set_BC(0x02);
+	cpu_reset_registers(gb);
+	cpu_set_BC(gb, 0x02);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x42);
 
 	// 0x0B: DEC BC
 	opcode = 0x0B;
-	cpu_reset_registers();
-	cpu_set_BC(0x77);
+	cpu_reset_registers(gb);
+	cpu_set_BC(gb, 0x77);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC() == 0x76);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_BC(gb) == 0x76);
 
 	// 0x0C : INC C
 	opcode = 0x0C;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0x01);
-	cpu_set_C(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0x01);
+	cpu_set_C(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0x00);
 
 	// 0x0D : DEC C
 	opcode = 0x0D;
-	cpu_reset_registers();
-	cpu_set_C(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xFF);
 
 	// 0x0E : LD C,d8
 	opcode = 0x0E;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xAF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xAF);
 
 	// 0x0F : RRC A
 	opcode = 0x0F;
-	cpu_reset_registers();
-	cpu_set_A(0x02);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x02);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x01 && cpu_get_F() == 0x00);
-	cpu_set_A(0x01);
+			      cpu_get_A(gb) == 0x01 && cpu_get_F(gb) == 0x00);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x80 && cpu_get_F() == 0x10);
-	cpu_set_A(0x00);
+			      cpu_get_A(gb) == 0x80 && cpu_get_F(gb) == 0x10);
+	cpu_set_A(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0x10 : STOP
 
 	// 0x11 : LD DE,d16
 	opcode = 0x11;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE() == 0x6745);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE(gb) == 0x6745);
 
 	// 0x12 : LD (DE), A
 	opcode = 0x12;
-	cpu_reset_registers();
-	cpu_set_A(0x91);
-	cpu_set_DE(0xFEDA);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x91);
+	cpu_set_DE(gb, 0xFEDA);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_DE()) == 0x91);
+			      mem_get_byte(gb, cpu_get_DE(gb)) == 0x91);
 
 	// 0x13 : INC DE
 	opcode = 0x13;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE() == 0x0001);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE(gb) == 0x0001);
 
 	// 0x14 : INC D
 	opcode = 0x14;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0x01);
-	cpu_set_D(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0x01);
+	cpu_set_D(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0x00);
 
 	// 0x15 : DEC D
 	opcode = 0x15;
-	cpu_reset_registers();
-	cpu_set_D(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xFF);
 
 	// 0x16 : LD D,d8
 	opcode = 0x16;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0x42);
 
 	// 0x17 : RL A
 	opcode = 0x17;
-	cpu_reset_registers();
-	cpu_set_A(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x02);
-	cpu_set_A(0xFE);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x02);
+	cpu_set_A(gb, 0xFE);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFC && cpu_get_F() == 0x10);
-	cpu_set_A(0x01);
+			      cpu_get_A(gb) == 0xFC && cpu_get_F(gb) == 0x10);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x03);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x03);
 
 	// 0x18: JR r8
 	printf("------------------- trying 0x18 : JR r8\n");
 	opcode = 0x18;
-	cpu_reset_registers();
-	//cpu_set_PC(0x1000);
-	cpu_set_PC(0x0800);
+	cpu_reset_registers(gb);
+	//cpu_set_PC(gb, 0x1000);
+	cpu_set_PC(gb, 0x0800);
 	//printf("[test] byte1 in mem = %d (0x%x)\n", (int8_t)mem[opcode].byte1);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
 	printf("int8_t byte1 = %d\n", (int8_t)opcode_dict[opcode].byte1);
 	printf("int8_t byte2 = %d\n", (int8_t)opcode_dict[opcode].byte2);
 	printf("[TEST] lg = %d\n", lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0801);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0801);
 
 	// 0x19: ADD HL,DE
 	opcode = 0x19;
-	cpu_reset_registers();
-	cpu_set_HL(0x1111);
-	cpu_set_DE(0x2222);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x1111);
+	cpu_set_DE(gb, 0x2222);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x3333);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x3333);
 	// test carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0xF000);
-	cpu_set_DE(0x2222);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xF000);
+	cpu_set_DE(gb, 0x2222);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x1222 && cpu_get_F() == 0x10);
+			      cpu_get_HL(gb) == 0x1222 && cpu_get_F(gb) == 0x10);
 	// test half carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0x00FF);
-	cpu_set_DE(0x0001);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x00FF);
+	cpu_set_DE(gb, 0x0001);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x0100 && cpu_get_F() == 0x20);
+			      cpu_get_HL(gb) == 0x0100 && cpu_get_F(gb) == 0x20);
 
 	// 0x1A: LD LD A,(DE)
 	opcode = 0x1A;
-	cpu_reset_registers();
-	cpu_set_DE(0x02);
+	cpu_reset_registers(gb);
+	cpu_set_DE(gb, 0x02);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x42);
 
 	// 0x1B: DEC DE
 	opcode = 0x1B;
-	cpu_reset_registers();
-	cpu_set_DE(0x77);
+	cpu_reset_registers(gb);
+	cpu_set_DE(gb, 0x77);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE() == 0x76);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_DE(gb) == 0x76);
 
 	// 0x1C : INC E
 	opcode = 0x1C;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0x01);
-	cpu_set_E(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0x01);
+	cpu_set_E(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0x00);
 
 	// 0x1D : DEC E
 	opcode = 0x1D;
-	cpu_reset_registers();
-	cpu_set_E(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xFF);
 
 	// 0x1E : LD C,d8
 	opcode = 0x1E;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xAF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xAF);
 
 	// 0x1F : RR A
 	opcode = 0x1F;
-	cpu_reset_registers();
-	cpu_set_A(0x02);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x02);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x01 && cpu_get_F() == 0x00);
-	cpu_set_A(0x01);
+			      cpu_get_A(gb) == 0x01 && cpu_get_F(gb) == 0x00);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x90);
-	cpu_set_A(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x90);
+	cpu_set_A(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x80 && cpu_get_F() == 0x00);
+			      cpu_get_A(gb) == 0x80 && cpu_get_F(gb) == 0x00);
 
 	// 0x20: JR NZ, r8
 	printf("------------------- trying 0x18 : JR r8\n");
 	opcode = 0x20;
-	cpu_reset_registers();
-	cpu_set_PC(0x0800);
+	cpu_reset_registers(gb);
+	cpu_set_PC(gb, 0x0800);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0801);
-	cpu_set_PC(0x0800);
-	cpu_set_F(0x80);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0801);
+	cpu_set_PC(gb, 0x0800);
+	cpu_set_F(gb, 0x80);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0802);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0802);
 
 	// 0x21 : LD HL,d16
 	opcode = 0x21;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x6745);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x6745);
 
 	// 0x22 : LD (HL+), A
 	opcode = 0x22;
-	cpu_reset_registers();
-	cpu_set_A(0x91);
-	cpu_set_HL(0xFEDA);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x91);
+	cpu_set_HL(gb, 0xFEDA);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL() - 1) == 0x91 &&
-				      cpu_get_HL() == 0xFEDB);
+			      mem_get_byte(gb, cpu_get_HL(gb) - 1) == 0x91 &&
+				      cpu_get_HL(gb) == 0xFEDB);
 
 	// 0x23 : INC HL
 	opcode = 0x23;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x0001);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x0001);
 
 	// 0x24 : INC H
 	opcode = 0x24;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0x01);
-	cpu_set_H(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0x01);
+	cpu_set_H(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0x00);
 
 	// 0x25 : DEC H
 	opcode = 0x25;
-	cpu_reset_registers();
-	cpu_set_H(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xFF);
 
 	// 0x26 : LD H,d8
 	opcode = 0x26;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0x42);
 
 	// 0x27 : DAA
 	// examples founds on https://www.tutorialspoint.com/daa-instruction-in-8085-microprocessor
 	opcode = 0x27;
-	cpu_reset_registers();
-	cpu_set_A(0x7D);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x7D);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x83);
-	cpu_reset_registers();
-	cpu_set_A(0x79);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x83);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x79);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x79);
-	cpu_reset_registers();
-	cpu_set_A(0xD7);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x79);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xD7);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x37);
-	cpu_reset_registers();
-	cpu_set_A(0xCC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x37);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xCC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x32);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x32);
 	// TODO: check all IF cases from function
 
 	// 0x28: JR Z, r8
 	opcode = 0x28;
-	cpu_reset_registers();
-	cpu_set_PC(0x0800);
-	cpu_set_F(0x80);
+	cpu_reset_registers(gb);
+	cpu_set_PC(gb, 0x0800);
+	cpu_set_F(gb, 0x80);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0801);
-	cpu_reset_registers();
-	cpu_set_PC(0x0800);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0801);
+	cpu_reset_registers(gb);
+	cpu_set_PC(gb, 0x0800);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0802);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0802);
 
 	// 0x29: ADD HL,HL
 	opcode = 0x29;
-	cpu_reset_registers();
-	cpu_set_HL(0x1111);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x1111);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x2222);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x2222);
 	// test carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0xF000);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xF000);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0xE000 && cpu_get_F() == 0x10);
+			      cpu_get_HL(gb) == 0xE000 && cpu_get_F(gb) == 0x10);
 	// test half carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0x00FF);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x00FF);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x01FE && cpu_get_F() == 0x20);
+			      cpu_get_HL(gb) == 0x01FE && cpu_get_F(gb) == 0x20);
 
 	// 0x2A : LD A, (HL+)
 	opcode = 0x2A;
-	cpu_reset_registers();
-	cpu_set_HL(0xFEDA);
-	mem_set_byte(cpu_get_HL(), 0x33);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xFEDA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x33 && cpu_get_HL() == 0xFEDB);
+			      cpu_get_A(gb) == 0x33 && cpu_get_HL(gb) == 0xFEDB);
 
 	// 0x2B: DEC HL
 	opcode = 0x2B;
-	cpu_reset_registers();
-	cpu_set_HL(0x77);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x77);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x76);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x76);
 
 	// 0x2C : INC L
 	opcode = 0x2C;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0x01);
-	cpu_set_L(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0x01);
+	cpu_set_L(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0x00);
 
 	// 0x2D : DEC L
 	opcode = 0x2D;
-	cpu_reset_registers();
-	cpu_set_L(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xFF);
 
 	// 0x2E : LD L,d8
 	opcode = 0x2E;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0x42);
 
 	// 0x2F : CPL
 	opcode = 0x2F;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
 
 	// 0x30: JR NC, r8
 	printf("------------------- trying 0x18 : JR r8\n");
 	opcode = 0x30;
-	cpu_reset_registers();
-	cpu_set_PC(0x0800);
+	cpu_reset_registers(gb);
+	cpu_set_PC(gb, 0x0800);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0801);
-	cpu_set_PC(0x0800);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0801);
+	cpu_set_PC(gb, 0x0800);
+	cpu_set_F(gb, 0x10);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0802);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0802);
 
 	// 0x31 : LD SP,d16
 	opcode = 0x31;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x6745);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0x6745);
 
 	// 0x32 : LD (HL-), A
 	opcode = 0x32;
-	cpu_reset_registers();
-	cpu_set_A(0x91);
-	cpu_set_HL(0xFEDA);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x91);
+	cpu_set_HL(gb, 0xFEDA);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL() + 1) == 0x91 &&
-				      cpu_get_HL() == 0xFED9);
+			      mem_get_byte(gb, cpu_get_HL(gb) + 1) == 0x91 &&
+				      cpu_get_HL(gb) == 0xFED9);
 
 	// 0x33 : INC SP
 	opcode = 0x33;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x0001);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0x0001);
 
 	// 0x34 : INC (HL)
 	opcode = 0x34;
-	cpu_reset_registers();
-	cpu_set_HL(0x5555);
-	mem_set_byte(0x5555, 0x66);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC555);
+	mem_set_byte(gb, 0xC555, 0x66);
 	cpu_test_opcode(opcode_dict[opcode]);
-	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(), mem_get_byte(cpu_get_HL()));
+	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(gb), mem_get_byte(gb, cpu_get_HL(gb)));
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0x67);
-	cpu_set_HL(0x5555);
-	mem_set_byte(0x5555, 0xFF);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0x67);
+	cpu_set_HL(gb, 0xC555);
+	mem_set_byte(gb, 0xC555, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(), mem_get_byte(cpu_get_HL()));
+	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(gb), mem_get_byte(gb, cpu_get_HL(gb)));
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0x00 &&
-				      cpu_get_F() == 0xA0);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0x00 &&
+				      cpu_get_F(gb) == 0xA0);
 
 	// 0x35 : DEC (HL)
 	opcode = 0x35;
-	cpu_reset_registers();
-	cpu_set_HL(0x5555);
-	mem_set_byte(0x5555, 0x66);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC555);
+	mem_set_byte(gb, 0xC555, 0x66);
 	cpu_test_opcode(opcode_dict[opcode]);
-	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(), mem_get_byte(cpu_get_HL()));
+	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(gb), mem_get_byte(gb, cpu_get_HL(gb)));
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0x65);
-	cpu_set_HL(0x5555);
-	mem_set_byte(0x5555, 0x00);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0x65);
+	cpu_set_HL(gb, 0xC555);
+	mem_set_byte(gb, 0xC555, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(), mem_get_byte(cpu_get_HL()));
+	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(gb), mem_get_byte(gb, cpu_get_HL(gb)));
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xFF &&
-				      cpu_get_F() == 0x20);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xFF &&
+				      cpu_get_F(gb) == 0x60);
 
 	// 0x36 : LD (HL), d8
 	opcode = 0x36;
-	cpu_reset_registers();
-	cpu_set_HL(0xFEDA);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xFEDA);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xAA &&
-				      cpu_get_HL() == 0xFEDA);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xAA &&
+				      cpu_get_HL(gb) == 0xFEDA);
 
 	// 0x37 : SCF
 	opcode = 0x37;
-	cpu_reset_registers();
-	cpu_set_F(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x90);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x90);
 
 	// 0x38: JR C, r8
 	opcode = 0x38;
-	cpu_reset_registers();
-	cpu_set_PC(0x0800);
-	cpu_set_F(0x10);
-	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(), mem_get_byte(cpu_get_HL()));
+	cpu_reset_registers(gb);
+	cpu_set_PC(gb, 0x0800);
+	cpu_set_F(gb, 0x10);
+	printf("mem[0x%x] = 0x%x\n", cpu_get_HL(gb), mem_get_byte(gb, cpu_get_HL(gb)));
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0801);
-	cpu_set_PC(0x0800);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0801);
+	cpu_set_PC(gb, 0x0800);
+	cpu_set_F(gb, 0x00);
 	lg = cpu_test_opcode(opcode_dict[opcode]);
-	cpu_set_PC(cpu_get_PC() + lg);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0802);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0802);
 
 	// 0x39: ADD HL,SP
 	opcode = 0x39;
-	cpu_reset_registers();
-	cpu_set_HL(0x1111);
-	cpu_set_SP(0x2222);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x1111);
+	cpu_set_SP(gb, 0x2222);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x3333);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x3333);
 	// test carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0xF000);
-	cpu_set_SP(0xFFFF);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xF000);
+	cpu_set_SP(gb, 0xFFFF);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0xEFFF && cpu_get_F() == 0x10);
+			      cpu_get_HL(gb) == 0xEFFF && cpu_get_F(gb) == 0x10);
 	// test half carry flag
-	cpu_reset_registers();
-	cpu_set_HL(0x00FF);
-	cpu_set_SP(0x0001);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x00FF);
+	cpu_set_SP(gb, 0x0001);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x0100 && cpu_get_F() == 0x20);
+			      cpu_get_HL(gb) == 0x0100 && cpu_get_F(gb) == 0x20);
 
 	// 0x3A : LD A, (HL-)
 	opcode = 0x3A;
-	cpu_reset_registers();
-	cpu_set_HL(0xFEDA);
-	mem_set_byte(cpu_get_HL(), 0x33);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xFEDA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x33 && cpu_get_HL() == 0xFED9);
+			      cpu_get_A(gb) == 0x33 && cpu_get_HL(gb) == 0xFED9);
 
 	// 0x3B: DEC SP
 	opcode = 0x3B;
-	cpu_reset_registers();
-	cpu_set_SP(0x77);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0x77);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x76);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0x76);
 
 	// 0x3C : INC A
 	opcode = 0x3C;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x01);
-	cpu_set_A(0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x01);
+	cpu_set_A(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x00);
 
 	// 0x3D : DEC A
 	opcode = 0x3D;
-	cpu_reset_registers();
-	cpu_set_A(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0x3E : LD A,d8
 	opcode = 0x3E;
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x42);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x42);
 
 	// 0x3F : SCF
 	opcode = 0x3F;
-	cpu_reset_registers();
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x10);
 
 	// 0x40 : LD B,B
 	opcode = 0x40;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x41 : LD B,C
 	opcode = 0x41;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x42 : LD B,D
 	opcode = 0x42;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x43 : LD B,E
 	opcode = 0x43;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x44 : LD B,H
 	opcode = 0x44;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x45 : LD B,L
 	opcode = 0x45;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x46 : LD B, (HL)
 	opcode = 0x46;
-	cpu_reset_registers();
-	cpu_set_HL(0xAAAA);
-	mem_set_byte(cpu_get_HL(), 0x33);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCAAA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0x33);
 
 	// 0x47 : LD B,A
 	opcode = 0x47;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_B() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_B(gb) == 0xDC);
 
 	// 0x48 : LD C,B
 	opcode = 0x48;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x49 : LD C,C
 	opcode = 0x49;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x4A : LD C,D
 	opcode = 0x4A;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x4B : LD C,E
 	opcode = 0x4B;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x4C : LD C,H
 	opcode = 0x4C;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x4D : LD C,L
 	opcode = 0x4D;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x4E : LD C, (HL)
 	opcode = 0x4E;
-	cpu_reset_registers();
-	cpu_set_HL(0xBBBB);
-	mem_set_byte(cpu_get_HL(), 0x44);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBBB);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0x44);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0x44);
 
 	// 0x4F : LD C,A
 	opcode = 0x4F;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_C() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_C(gb) == 0xDC);
 
 	// 0x50 : LD D,B
 	opcode = 0x50;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x51 : LD D,C
 	opcode = 0x51;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x52 : LD B,D
 	opcode = 0x52;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x53 : LD D,E
 	opcode = 0x53;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x54 : LD D,H
 	opcode = 0x54;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x55 : LD D,L
 	opcode = 0x55;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x56 : LD D, (HL)
 	opcode = 0x56;
-	cpu_reset_registers();
-	cpu_set_HL(0xAAAA);
-	mem_set_byte(cpu_get_HL(), 0x33);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCAAA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0x33);
 
 	// 0x57 : LD D,A
 	opcode = 0x57;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_D() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_D(gb) == 0xDC);
 
 	// 0x58 : LD E,B
 	opcode = 0x58;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x59 : LD E,C
 	opcode = 0x59;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x5A : LD E,D
 	opcode = 0x5A;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x5B : LD E,E
 	opcode = 0x5B;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x5C : LD E,H
 	opcode = 0x5C;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x5D : LD E,L
 	opcode = 0x5D;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x5E : LD C, (HL)
 	opcode = 0x5E;
-	cpu_reset_registers();
-	cpu_set_HL(0xBBBB);
-	mem_set_byte(cpu_get_HL(), 0x44);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBBB);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0x44);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0x44);
 
 	// 0x5F : LD E,A
 	opcode = 0x5F;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_E() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_E(gb) == 0xDC);
 
 	// 0x60 : LD H,B
 	opcode = 0x60;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x61 : LD H,C
 	opcode = 0x61;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x62 : LD H,D
 	opcode = 0x62;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x63 : LD H,E
 	opcode = 0x63;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x64 : LD H,H
 	opcode = 0x64;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x65 : LD H,L
 	opcode = 0x65;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x66 : LD H, (HL)
 	opcode = 0x66;
-	cpu_reset_registers();
-	cpu_set_HL(0xAAAA);
-	mem_set_byte(cpu_get_HL(), 0x33);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCAAA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0x33);
 
 	// 0x67 : LD H,A
 	opcode = 0x67;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_H() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_H(gb) == 0xDC);
 
 	// 0x68 : LD L,B
 	opcode = 0x68;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x69 : LD L,C
 	opcode = 0x69;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x6A : LD L,D
 	opcode = 0x6A;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x6B : LD L,E
 	opcode = 0x6B;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x6C : LD L,H
 	opcode = 0x6C;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x6D : LD L,L
 	opcode = 0x6D;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x6E : LD L, (HL)
 	opcode = 0x6E;
-	cpu_reset_registers();
-	cpu_set_HL(0xBBBB);
-	mem_set_byte(cpu_get_HL(), 0x44);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBBB);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0x44);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0x44);
 
 	// 0x6F : LD L,A
 	opcode = 0x6F;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_L() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_L(gb) == 0xDC);
 
 	// 0x70 : LD (HL),B
 	opcode = 0x70;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_B(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_B(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x71 : LD (HL),C
 	opcode = 0x71;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_C(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_C(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x72 : LD (HL),D
 	opcode = 0x72;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_D(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_D(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x73 : LD (HL),E
 	opcode = 0x73;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_E(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_E(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x74 : LD (HL),H
 	opcode = 0x74;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_H(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_H(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x75 : LD (HL),L
 	opcode = 0x75;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_L(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_L(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x77 : LD (HL),A
 	opcode = 0x77;
-	cpu_reset_registers();
-	cpu_set_HL(0xABD0);
-	cpu_set_A(0xDD);
-	mem_set_byte(cpu_get_HL(), 0x00);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xCBD0);
+	cpu_set_A(gb, 0xDD);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDD);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDD);
 
 	// 0x78 : LD A,B
 	opcode = 0x78;
-	cpu_reset_registers();
-	cpu_set_B(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x79 : LD A,C
 	opcode = 0x79;
-	cpu_reset_registers();
-	cpu_set_C(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x7A : LD A,D
 	opcode = 0x7A;
-	cpu_reset_registers();
-	cpu_set_D(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_D(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x7B : LD A,E
 	opcode = 0x7B;
-	cpu_reset_registers();
-	cpu_set_E(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_E(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x7C : LD A,H
 	opcode = 0x7C;
-	cpu_reset_registers();
-	cpu_set_H(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_H(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x7D : LD A,L
 	opcode = 0x7D;
-	cpu_reset_registers();
-	cpu_set_L(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_L(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x7E : LD A, (HL)
 	opcode = 0x7E;
-	cpu_reset_registers();
-	cpu_set_HL(0xDC12);
-	mem_set_byte(cpu_get_HL(), 0x44);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xDC12);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x44);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x44);
 
 	// 0x7F : LD A,A
 	opcode = 0x7F;
-	cpu_reset_registers();
-	cpu_set_A(0xDC);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xDC);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xDC);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xDC);
 
 	// 0x80 : ADD A,B
 	opcode = 0x80;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_B(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_B(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_B(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_B(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_B(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_B(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x81 : ADD A,C
 	opcode = 0x81;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_C(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_C(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_C(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_C(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_C(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_C(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x82 : ADD A,D
 	opcode = 0x82;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_D(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_D(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_D(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_D(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_D(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_D(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x83 : ADD A,E
 	opcode = 0x83;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_E(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_E(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_E(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_E(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_E(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_E(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x84 : ADD A,H
 	opcode = 0x84;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_H(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_H(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_H(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_H(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_H(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_H(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x85 : ADD A,L
 	opcode = 0x85;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_L(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_L(gb, 0x01);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0F);
-	cpu_set_L(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_L(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_L(0x01);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_L(gb, 0x01);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x86 : ADD A,(HL)
 	opcode = 0x86;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_HL(0x8525);
-	mem_set_byte(cpu_get_HL(), 0x71);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_HL(gb, 0x8525);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x71);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x7A);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x7A);
 
 	// 0x87 : ADD A,A
 	opcode = 0x87;
-	cpu_reset_registers();
-	cpu_set_A(0x03);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x03);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x06);
-	cpu_set_A(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x06);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFE && cpu_get_F() == 0x30);
+			      cpu_get_A(gb) == 0xFE && cpu_get_F(gb) == 0x30);
 
 	// 0x88 : ADC A,B
 	opcode = 0x88;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_B(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_B(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_B(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_B(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_B(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_B(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x89 : ADC A,C
 	opcode = 0x89;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_C(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_C(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_C(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_C(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_C(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_C(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x8A : ADC A,D
 	opcode = 0x8A;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_D(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_D(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_D(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_D(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_D(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_D(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x8B : ADC A,E
 	opcode = 0x8B;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_E(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_E(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_E(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_E(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_E(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_E(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x8C : ADC A,H
 	opcode = 0x8C;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_H(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_H(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_H(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_H(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_H(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_H(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x8D : ADC A,L
 	opcode = 0x8D;
-	cpu_reset_registers();
-	cpu_set_A(0x08);
-	cpu_set_L(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x08);
+	cpu_set_L(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0A);
-	cpu_set_A(0x0E);
-	cpu_set_L(0x0F);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0A);
+	cpu_set_A(gb, 0x0E);
+	cpu_set_L(gb, 0x0F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFE);
-	cpu_set_L(0x01);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_L(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xB0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xB0);
 
 	// 0x8E : ADC A,(HL)
 	opcode = 0x8E;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_HL(0x8525);
-	mem_set_byte(cpu_get_HL(), 0x71);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_HL(gb, 0x8525);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x71);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x7A);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x7A);
 
 	// 0x8F : ADC A,A
 	opcode = 0x8F;
-	cpu_reset_registers();
-	cpu_set_A(0x03);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x03);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x06);
-	cpu_set_A(0x0F);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x06);
+	cpu_set_A(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x1E && cpu_get_F() == 0x20);
-	cpu_set_A(0xFF);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x1E && cpu_get_F(gb) == 0x20);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFE && cpu_get_F() == 0x30);
+			      cpu_get_A(gb) == 0xFE && cpu_get_F(gb) == 0x30);
 
 	// 0x90 : SUB A,B
 	opcode = 0x90;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_B(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_B(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_B(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_B(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_B(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_B(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x91 : SUB A,C
 	opcode = 0x91;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_C(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_C(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_C(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_C(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_C(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_C(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x92 : SUB A,D
 	opcode = 0x92;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_D(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_D(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_D(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_D(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_D(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_D(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x93 : SUB A,E
 	opcode = 0x93;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_E(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_E(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_E(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_E(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_E(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_E(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x94 : SUB A,H
 	opcode = 0x94;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_H(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_H(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_H(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_H(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_H(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_H(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x95 : SUB A,L
 	opcode = 0x95;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_L(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_L(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_L(0x0F);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_L(gb, 0x0F);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_L(0x05);
-	cpu_set_F(0x00);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_L(gb, 0x05);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x96 : SUB A,(HL)
 	opcode = 0x96;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_HL(0x7531);
-	mem_set_byte(cpu_get_HL(), 0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_HL(gb, 0xC531);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
 
 	// 0x97 : SUB A,A
 	opcode = 0x97;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
 
 	// 0x98 : SBC A,B
 	opcode = 0x98;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_B(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_B(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_B(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_B(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_B(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_B(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x99 : SBC A,C
 	opcode = 0x99;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_C(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_C(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_C(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_C(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_C(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_C(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x9A : SBC A,D
 	opcode = 0x9A;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_D(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_D(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_D(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_D(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_D(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_D(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x9B : SBC A,E
 	opcode = 0x9B;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_E(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_E(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_E(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_E(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_E(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_E(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x9C : SBC A,H
 	opcode = 0x9C;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_H(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_H(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_H(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_H(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_H(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_H(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x9D : SBC A,L
 	opcode = 0x9D;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_L(0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_L(gb, 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
-	cpu_set_A(0xFE);
-	cpu_set_L(0x0E);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
+	cpu_set_A(gb, 0xFE);
+	cpu_set_L(gb, 0x0E);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xEF && cpu_get_F() == 0x60);
-	cpu_set_A(0x04);
-	cpu_set_L(0x04);
-	cpu_set_F(0x10);
+			      cpu_get_A(gb) == 0xEF && cpu_get_F(gb) == 0x60);
+	cpu_set_A(gb, 0x04);
+	cpu_set_L(gb, 0x04);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0x9E : SBC A,(HL)
 	opcode = 0x9E;
-	cpu_reset_registers();
-	cpu_set_A(0x09);
-	cpu_set_HL(0x7531);
-	mem_set_byte(cpu_get_HL(), 0x08);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x09);
+	cpu_set_HL(gb, 0xC531);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x08);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xC0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xC0);
 
 	// 0x9F : SBC A,A
 	opcode = 0x9F;
-	cpu_reset_registers();
-	cpu_set_A(0x01);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x01);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x70);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x70);
 
 	// 0xA0 : AND A,B
 	opcode = 0xA0;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_B(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_B(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_B(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_B(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA1 : AND A,C
 	opcode = 0xA1;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_C(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_C(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_C(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_C(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA2 : AND A,D
 	opcode = 0xA2;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_D(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_D(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_D(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_D(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA3 : AND A,E
 	opcode = 0xA3;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_E(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_E(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_E(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_E(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA4 : AND A,H
 	opcode = 0xA4;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_H(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_H(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_H(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_H(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA5 : AND A,L
 	opcode = 0xA5;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_L(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_L(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
-	cpu_set_A(0xFF);
-	cpu_set_L(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_L(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0xA0);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0xA0);
 
 	// 0xA6 : AND A,(HL)
 	opcode = 0xA6;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
-	cpu_set_HL(0xDADA);
-	mem_set_byte(cpu_get_HL(), 0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
+	cpu_set_HL(gb, 0xDADA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x0F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x0F);
 
 	// 0xA7 : AND A,A
 	opcode = 0xA7;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0xFF && cpu_get_F() == 0x20);
+			      cpu_get_A(gb) == 0xFF && cpu_get_F(gb) == 0x20);
 
 	// 0xA8 : XOR A,B
 	opcode = 0xA8;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_B(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_B(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_B(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_B(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xA9 : XOR A,C
 	opcode = 0xA9;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_C(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_C(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_C(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_C(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xAA : XOR A,D
 	opcode = 0xAA;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_D(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_D(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_D(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_D(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xAB : XOR A,E
 	opcode = 0xAB;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_E(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_E(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_E(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_E(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xAC : XOR A,H
 	opcode = 0xAC;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_H(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_H(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_H(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_H(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xAD : XOR A,L
 	opcode = 0xAD;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_L(0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_L(gb, 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
-	cpu_set_A(0xF0);
-	cpu_set_L(0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_L(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xAE : XOR A,(HL)
 	opcode = 0xAE;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
-	cpu_set_HL(0xDADA);
-	mem_set_byte(cpu_get_HL(), 0x15);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
+	cpu_set_HL(gb, 0xDADA);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x15);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x3E);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x3E);
 
 	// 0xAF : XOR A,A
 	opcode = 0xAF;
-	cpu_reset_registers();
-	cpu_set_A(0x2B);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x2B);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_A() == 0x00 && cpu_get_F() == 0x80);
+			      cpu_get_A(gb) == 0x00 && cpu_get_F(gb) == 0x80);
 
 	// 0xB0 : AND A,B
 	opcode = 0xB0;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_B(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_B(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB1 : AND A,C
 	opcode = 0xB1;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_C(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_C(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB2 : AND A,D
 	opcode = 0xB2;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_D(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_D(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB3 : AND A,E
 	opcode = 0xB3;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_E(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_E(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB4 : AND A,H
 	opcode = 0xB4;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_H(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_H(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB5 : AND A,L
 	opcode = 0xB5;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_L(0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_L(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB6 : AND A,(HL)
 	opcode = 0xB6;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
-	cpu_set_HL(0x8527);
-	mem_set_byte(cpu_get_HL(), 0x0F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
+	cpu_set_HL(gb, 0x8527);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xB7 : AND A,A
 	opcode = 0xB;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xF0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xF0);
 
 	// 0xB8 : CP A,B
 	opcode = 0xB8;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_B(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_B(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_B(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_B(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_B(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_B(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xB9 : CP A,C
 	opcode = 0xB9;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_C(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_C(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_C(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_C(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_C(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_C(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xBA : CP A,D
 	opcode = 0xBA;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_D(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_D(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_D(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_D(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_D(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_D(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xBB : CP A,E
 	opcode = 0xBB;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_E(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_E(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_E(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_E(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_E(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_E(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xBC : CP A,H
 	opcode = 0xBC;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_H(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_H(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_H(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_H(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_H(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_H(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xBD : CP A,L
 	opcode = 0xBD;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_L(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_L(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_L(0x2F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_L(gb, 0x2F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
-	cpu_set_L(0x1F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
+	cpu_set_L(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xBE : CP A,(HL)
 	opcode = 0xBE;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
-	cpu_set_HL(0x1511);
-	mem_set_byte(cpu_get_HL(), 0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
+	cpu_set_HL(gb, 0xC511);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
 
 	// 0xBF : CP A,A
 	opcode = 0xBF;
-	cpu_reset_registers();
-	cpu_set_A(0x1F);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x1F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
 
 	// 0xC0 : RT NZ
 	opcode = 0xC0;
-	cpu_reset_registers();
-	cpu_set_F(0x80);
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x80);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x5432 && cpu_get_SP() == 0x0FFE);
-	cpu_set_F(0x00);
+			      cpu_get_PC(gb) == 0x5433 && cpu_get_SP(gb) == 0xCFFE);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xC1 : POP BC
 	opcode = 0xC1;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	mem_set_byte(cpu_get_SP(), 0x21);
-	mem_set_byte(cpu_get_SP() + 1, 0x43);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	mem_set_byte(gb, cpu_get_SP(gb), 0x21);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0x43);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_BC() == 0x4321 && cpu_get_SP() == 0x1000);
+			      cpu_get_BC(gb) == 0x4321 && cpu_get_SP(gb) == 0xD000);
 
 	// 0xC2 : JP NZ,a16
 	opcode = 0xC2;
-	cpu_reset_registers();
-	cpu_set_F(0x80);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x80);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0000);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0003);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x6543);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x6543);
 
 	// 0xC3 : JP a16
 	opcode = 0xC3;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x6543);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x6543);
 
 	// 0xC4 : CALL NZ,a16
 	opcode = 0xC4;
-	cpu_reset_registers();
-	cpu_set_F(0x80);
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x80);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xCBCD);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xABCD && cpu_get_SP() == 0x1000);
-	cpu_set_F(0x00);
+			      cpu_get_PC(gb) == 0xCBD0 && cpu_get_SP(gb) == 0xD000);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x7654 && cpu_get_SP() == 0x0FFE);
+			      cpu_get_PC(gb) == 0x7654 && cpu_get_SP(gb) == 0xCFFE);
 
 	// 0xC5 : PUSH BC
 	opcode = 0xC5;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_BC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_BC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x0FFE);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0xCFFE);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD0 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xC6 : ADD A,d8
 	opcode = 0xC6;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x33);
 
 	// 0xC7 : RST 00h
 	opcode = 0xC7;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0000);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0000);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xC8 : RET Z
 	opcode = 0xC8;
-	cpu_reset_registers();
-	cpu_set_F(0x00);
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x00);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x5432 && cpu_get_SP() == 0x0FFE);
-	cpu_set_F(0x80);
+			      cpu_get_PC(gb) == 0x5433 && cpu_get_SP(gb) == 0xCFFE);
+	cpu_set_F(gb, 0x80);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xC9 : RET
 	opcode = 0xC9;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xCA : JP Z,a16
 	opcode = 0xCA;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0000);
-	cpu_set_F(0x80);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0003);
+	cpu_set_F(gb, 0x80);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x6543);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x6543);
 
 	// 0xCC : CALL Z,a16
 	opcode = 0xCC;
-	cpu_reset_registers();
-	cpu_set_F(0x00);
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x00);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xCBCD);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xABCD && cpu_get_SP() == 0x1000);
-	cpu_set_F(0x80);
+			      cpu_get_PC(gb) == 0xCBD0 && cpu_get_SP(gb) == 0xD000);
+	cpu_set_F(gb, 0x80);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x7654 && cpu_get_SP() == 0x0FFE);
+			      cpu_get_PC(gb) == 0x7654 && cpu_get_SP(gb) == 0xCFFE);
 
 	// 0xCD : CALL a16
 	opcode = 0xCD;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xCBCD);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x7654 && cpu_get_SP() == 0x0FFE);
+			      cpu_get_PC(gb) == 0x7654 && cpu_get_SP(gb) == 0xCFFE);
 
 	// 0xCE : ADC A,d8
 	opcode = 0xCE;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x33);
 
 	// 0xCF : RST 08h
 	opcode = 0xCF;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0008);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0008);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xD0 : RET NC
 	opcode = 0xD0;
-	cpu_reset_registers();
-	cpu_set_F(0x10);
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x10);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x5432 && cpu_get_SP() == 0x0FFE);
-	cpu_set_F(0x00);
+			      cpu_get_PC(gb) == 0x5433 && cpu_get_SP(gb) == 0xCFFE);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xD1 : POP DE
 	opcode = 0xD1;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	mem_set_byte(cpu_get_SP(), 0x21);
-	mem_set_byte(cpu_get_SP() + 1, 0x43);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	mem_set_byte(gb, cpu_get_SP(gb), 0x21);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0x43);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_DE() == 0x4321 && cpu_get_SP() == 0x1000);
+			      cpu_get_DE(gb) == 0x4321 && cpu_get_SP(gb) == 0xD000);
 
 	// 0xD2 : JP NC,a16
 	opcode = 0xD2;
-	cpu_reset_registers();
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0000);
-	cpu_set_F(0x00);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0003);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x6543);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x6543);
 
 	// 0xD4 : CALL NC,a16
 	opcode = 0xD4;
-	cpu_reset_registers();
-	cpu_set_F(0x10);
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x10);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xCBCD);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xABCD && cpu_get_SP() == 0x1000);
-	cpu_set_F(0x00);
+			      cpu_get_PC(gb) == 0xCBD0 && cpu_get_SP(gb) == 0xD000);
+	cpu_set_F(gb, 0x00);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x7654 && cpu_get_SP() == 0x0FFE);
+			      cpu_get_PC(gb) == 0x7654 && cpu_get_SP(gb) == 0xCFFE);
 
 	// 0xD5 : PUSH DE
 	opcode = 0xD5;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_DE(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_DE(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x0FFE);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0xCFFE);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD0 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xD6 : ADD A,d8
 	opcode = 0xD6;
-	cpu_reset_registers();
-	cpu_set_A(0x44);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x11);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x11);
 
 	// 0xD7 : RST 10h
 	opcode = 0xD7;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0010);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0010);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xD8 : RET C
 	opcode = 0xD8;
-	cpu_reset_registers();
-	cpu_set_F(0x00);
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x00);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x5432 && cpu_get_SP() == 0x0FFE);
-	cpu_set_F(0x10);
+			      cpu_get_PC(gb) == 0x5433 && cpu_get_SP(gb) == 0xCFFE);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xD9 : RETI
 	opcode = 0xD9;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	cpu_set_PC(0x5432);
-	mem_set_byte(cpu_get_SP(), 0xCA);
-	mem_set_byte(cpu_get_SP() + 1, 0xDB);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	cpu_set_PC(gb, 0x5432);
+	mem_set_byte(gb, cpu_get_SP(gb), 0xCA);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0xDB);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xDBCA && cpu_get_SP() == 0x1000);
+			      cpu_get_PC(gb) == 0xDBCA && cpu_get_SP(gb) == 0xD000);
 
 	// 0xDA : JP C,a16
 	opcode = 0xDA;
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x0000);
-	cpu_set_F(0x10);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x0003);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x6543);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x6543);
 
 	// 0xDC : CALL C,a16
 	opcode = 0xDC;
-	cpu_reset_registers();
-	cpu_set_F(0x00);
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xABCD);
+	cpu_reset_registers(gb);
+	cpu_set_F(gb, 0x00);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xCBCD);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0xABCD && cpu_get_SP() == 0x1000);
-	cpu_set_F(0x10);
+			      cpu_get_PC(gb) == 0xCBD0 && cpu_get_SP(gb) == 0xD000);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_PC() == 0x7654 && cpu_get_SP() == 0x0FFE);
+			      cpu_get_PC(gb) == 0x7654 && cpu_get_SP(gb) == 0xCFFE);
 
 	// 0xDE : SDC A,d8
 	opcode = 0xDE;
-	cpu_reset_registers();
-	cpu_set_A(0x44);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x11);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x11);
 
 	// 0xDF : RST 18h
 	opcode = 0xDF;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0018);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0018);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xE0 : LDH (a8),A8
 	opcode = 0xE0;
-	cpu_reset_registers();
-	cpu_set_A(0x44);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(
 		opcode_dict[opcode],
-		mem_get_byte(0xFF00 + opcode_dict[opcode].byte1) == 0x44);
+		mem_get_byte(gb, 0xFF00 + opcode_dict[opcode].byte1) == 0x44);
 
 	// 0xE1 : POP HL
 	opcode = 0xE1;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	mem_set_byte(cpu_get_SP(), 0x21);
-	mem_set_byte(cpu_get_SP() + 1, 0x43);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	mem_set_byte(gb, cpu_get_SP(gb), 0x21);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0x43);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == 0x4321 && cpu_get_SP() == 0x1000);
+			      cpu_get_HL(gb) == 0x4321 && cpu_get_SP(gb) == 0xD000);
 
 	// 0xE2 : LD (C),A
 	opcode = 0xE2;
-	cpu_reset_registers();
-	cpu_set_A(0x42);
-	cpu_set_C(0x33);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x42);
+	cpu_set_C(gb, 0x33);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      mem_get_byte(0xFF33) == 0x0042);
+			      mem_get_byte(gb, 0xFF33) == 0x0042);
 
 	// 0xE5 : PUSH HL
 	opcode = 0xE5;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_HL(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_HL(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x0FFE);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0xCFFE);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD0 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xE6 : AND d8
 	opcode = 0xE6;
-	cpu_reset_registers();
-	cpu_set_A(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xFF);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x33);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x33);
 
 	// 0xE7 : RST 20h
 	opcode = 0xE7;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0020);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0020);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xE8: ADD SP,r8
 	opcode = 0xE8;
-	cpu_reset_registers();
-	cpu_set_SP(0x1111);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0x1111);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x1116);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0x1116);
 
 	// 0xE9 : JP (HL)
 	opcode = 0xE9;
-	cpu_reset_registers();
-	cpu_set_HL(0x8527);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x8527);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC() == 0x8527);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_PC(gb) == 0x8527);
 
 	// 0xEA : LD (a16),A
 	opcode = 0xEA;
-	cpu_reset_registers();
-	cpu_set_A(0x44);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x44);
 	cpu_test_opcode(opcode_dict[opcode]);
 	u16 = opcode_dict[opcode].byte1 | opcode_dict[opcode].byte2 << 8;
-	cpu_print_test_result(opcode_dict[opcode], mem_get_byte(u16) == 0x44);
+	cpu_print_test_result(opcode_dict[opcode], mem_get_byte(gb, u16) == 0x44);
 
 	// 0xEE : XOR d8
 	opcode = 0xEE;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xEF : RST 28h
 	opcode = 0xEF;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0028);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0028);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xF0 : LDH A8,(a8)
 	opcode = 0xF0;
-	cpu_reset_registers();
-	mem_set_byte(0xFF00 | opcode_dict[opcode].byte1, 0x85);
+	cpu_reset_registers(gb);
+	mem_set_byte(gb, 0xFF00 | opcode_dict[opcode].byte1, 0x85);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x85);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x85);
 
 	// 0xF1 : POP AF
 	opcode = 0xF1;
-	cpu_reset_registers();
-	cpu_set_SP(0x0FFE);
-	mem_set_byte(cpu_get_SP(), 0x21);
-	mem_set_byte(cpu_get_SP() + 1, 0x43);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xCFFE);
+	mem_set_byte(gb, cpu_get_SP(gb), 0x21);
+	mem_set_byte(gb, cpu_get_SP(gb) + 1, 0x43);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_AF() == 0x4321 && cpu_get_SP() == 0x1000);
+			      cpu_get_AF(gb) == 0x4321 && cpu_get_SP(gb) == 0xD000);
 
 	// 0xF2 : LD A,(C)
 	opcode = 0xF2;
-	cpu_reset_registers();
-	cpu_set_C(0x12);
-	mem_set_byte(0xFF00 | cpu_get_C(), 0x96);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x12);
+	mem_set_byte(gb, 0xFF00 | cpu_get_C(gb), 0x96);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0x96);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0x96);
 
 	// 0xF5 : PUSH AF
 	opcode = 0xF5;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_AF(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_AF(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP() == 0x0FFE);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_SP(gb) == 0xCFFE);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD0 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xF6 : OR d8
 	opcode = 0xF6;
-	cpu_reset_registers();
-	cpu_set_A(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF0);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xFF);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xFF);
 
 	// 0xF7 : RST 30H
 	opcode = 0xF7;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0030);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0030);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
 
 	// 0xF8 : LD HL,SP+r8
 	opcode = 0xF8;
-	cpu_reset_registers();
-	cpu_set_SP(0x1111);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0x1111);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL() == 0x1166);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_HL(gb) == 0x1166);
 
 	// 0xF9 : LD SP,HL
 	opcode = 0xF9;
-	cpu_reset_registers();
-	cpu_set_HL(0x6543);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0x6543);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_HL() == cpu_get_SP());
+			      cpu_get_HL(gb) == cpu_get_SP(gb));
 
 	// 0xFA : LD A,(a16)
 	opcode = 0xFA;
-	cpu_reset_registers();
-	mem_set_byte(0x1551, 0xAB);
+	cpu_reset_registers(gb);
+	mem_set_byte(gb, 0xC551, 0xAB);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_A() == 0xAB);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_A(gb) == 0xAB);
 
 	// 0xFE : CP d8
 	opcode = 0xFE;
-	cpu_reset_registers();
-	cpu_set_A(0x77);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x77);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0xC0);
-	cpu_reset_registers();
-	cpu_set_A(0x0F);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0xC0);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0x0F);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x50);
-	cpu_reset_registers();
-	cpu_set_A(0xF1);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x50);
+	cpu_reset_registers(gb);
+	cpu_set_A(gb, 0xF1);
 	cpu_test_opcode(opcode_dict[opcode]);
-	cpu_print_test_result(opcode_dict[opcode], cpu_get_F() == 0x60);
+	cpu_print_test_result(opcode_dict[opcode], cpu_get_F(gb) == 0x60);
 
 	// 0xFF : RST 38h
 	opcode = 0xFF;
-	cpu_reset_registers();
-	cpu_set_SP(0x1000);
-	cpu_set_PC(0xD1D0);
+	cpu_reset_registers(gb);
+	cpu_set_SP(gb, 0xD000);
+	cpu_set_PC(gb, 0xD1D0);
 	cpu_test_opcode(opcode_dict[opcode]);
 	cpu_print_test_result(opcode_dict[opcode],
-			      cpu_get_SP() == 0x0FFE && cpu_get_PC() == 0x0038);
-	if (mem_get_byte(cpu_get_SP()) != 0xD0 ||
-	    mem_get_byte(cpu_get_SP() + 1) != 0xD1) {
+			      cpu_get_SP(gb) == 0xCFFE && cpu_get_PC(gb) == 0x0038);
+	if (mem_get_byte(gb, cpu_get_SP(gb)) != 0xD1 ||
+	    mem_get_byte(gb, cpu_get_SP(gb) + 1) != 0xD1) {
 		printf("unexpected memory configuration for instruction 0x%x\n",
 		       opcode);
 	}
@@ -2962,17 +2959,17 @@ int test_flag(cpu_flag_action action, cpu_flag_name flag, cpu_flag_value value,
 {
 	switch (action) {
 	case FLAG_SET:
-		cpu_set_flag(flag, value);
+		cpu_set_flag(gb, flag, value);
 		break;
 	case FLAG_GET:
 		break;
 	}
-	if (cpu_get_F() != expected_value) {
-		printf("FLAG Register 'F' = 0x%x\n", cpu_get_F());
+	if (cpu_get_F(gb) != expected_value) {
+		printf("FLAG Register 'F' = 0x%x\n", cpu_get_F(gb));
 		printf("[ERROR][%s:%d] action %s failed for flag %d\n",
 		       __func__, __LINE__, action == FLAG_SET ? "SET" : "GET",
 		       flag);
-		exit(0);
+		exit(1);
 	} else {
 		printf("[SUCCESS] FLAG action %s on flag %d\n",
 		       action == FLAG_SET ? "SET" : "GET", flag);
@@ -2986,9 +2983,9 @@ int testsuite_flags()
 	printf("\n####################### CPU FLAGS UTEST #########################\n");
 
 	//struct cpu_registers regs = {};
-	cpu_reset_registers();
+	cpu_reset_registers(gb);
 
-	printf("FLAG Register 'F' = 0x%x (init state)\n", cpu_get_F());
+	printf("FLAG Register 'F' = 0x%x (init state)\n", cpu_get_F(gb));
 
 	test_flag(FLAG_SET, FLAG_ZERO, TRUE, 0x80);
 	test_flag(FLAG_SET, FLAG_SUB, TRUE, 0xC0);
@@ -3287,387 +3284,387 @@ int testsuite_opcodes_CB()
 	uint8_t lg = 0;
 	uint8_t opcode = 0x00;
 	uint16_t u16;
-	cpu_reset_registers();
-	void cpu_reset_registers();
+	cpu_reset_registers(gb);
+	void cpu_reset_registers(struct gb *gb);
 	memset(memfull, 0, 8000);
 
 	// 0x00 : RLC B
 	opcode = 0x00;
-	cpu_reset_registers();
-	cpu_set_B(0xF0);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xF0);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_B() == 0xE1 && cpu_get_F() == 0x10);
+			      cpu_get_B(gb) == 0xE1 && cpu_get_F(gb) == 0x10);
 
 	// 0x06 : RLC (HL)
 	opcode = 0x06;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF0);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF0);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xE1 && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xE1 && cpu_get_F(gb) == 0x10);
 
 	// 0x09 : RRC C
 	opcode = 0x09;
-	cpu_reset_registers();
-	cpu_set_C(0xF1);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0xF1);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_C() == 0xF8 && cpu_get_F() == 0x10);
+			      cpu_get_C(gb) == 0xF8 && cpu_get_F(gb) == 0x10);
 
 	// 0x0E : RRC (HL)
 	opcode = 0x0E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF1);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF1);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xF8 && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xF8 && cpu_get_F(gb) == 0x10);
 
 	// 0x10 : RL B
 	opcode = 0x10;
-	cpu_reset_registers();
-	cpu_set_B(0xEF);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xEF);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_B() == 0xDF && cpu_get_F() == 0x10);
+			      cpu_get_B(gb) == 0xDF && cpu_get_F(gb) == 0x10);
 
 	// 0x16 : RL (HL)
 	opcode = 0x16;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xEF);	
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xEF);	
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xDF && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xDF && cpu_get_F(gb) == 0x10);
 
 	// 0x19 : RR C
 	opcode = 0x19;
-	cpu_reset_registers();
-	cpu_set_C(0x7F);
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x7F);
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_C() == 0xBF && cpu_get_F() == 0x10);
+			      cpu_get_C(gb) == 0xBF && cpu_get_F(gb) == 0x10);
 
 	// 0x1E : RR (HL)
 	opcode = 0x1E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x7F);	
-	cpu_set_F(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x7F);	
+	cpu_set_F(gb, 0x10);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xBF && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xBF && cpu_get_F(gb) == 0x10);
 
 	// 0x20 : SLA B
 	opcode = 0x20;
-	cpu_reset_registers();
-	cpu_set_B(0x88);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x88);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_B() == 0x10 && cpu_get_F() == 0x10);
+			      cpu_get_B(gb) == 0x10 && cpu_get_F(gb) == 0x10);
 
 	// 0x26 : SLA (HL)
 	opcode = 0x26;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x88);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x88);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0x10 && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0x10 && cpu_get_F(gb) == 0x10);
 
 	// 0x29 : SRA C
 	opcode = 0x29;
-	cpu_reset_registers();
-	cpu_set_C(0x81);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x81);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_C() == 0xC0 && cpu_get_F() == 0x10);
+			      cpu_get_C(gb) == 0xC0 && cpu_get_F(gb) == 0x10);
 
 	// 0x2E : SRA (HL)
 	opcode = 0x2E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x81);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x81);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0xC0 && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0xC0 && cpu_get_F(gb) == 0x10);
 
 	// 0x30 : SWAP B
 	opcode = 0x30;
-	cpu_reset_registers();
-	cpu_set_B(0xA1);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xA1);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x1A);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x1A);
 
 	// 0x36 : SWAP (HL)
 	opcode = 0x36;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xA1);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xA1);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(cpu_get_HL()) == 0x1A);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, cpu_get_HL(gb)) == 0x1A);
 
 	// 0x39 : SRL C
 	opcode = 0x39;
-	cpu_reset_registers();
-	cpu_set_C(0x81);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x81);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      cpu_get_C() == 0x40 && cpu_get_F() == 0x10);
+			      cpu_get_C(gb) == 0x40 && cpu_get_F(gb) == 0x10);
 
 	// 0x3E : SRL (HL)
 	opcode = 0x3E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x81);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x81);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
 	cpu_print_test_result(opcode_dict_CB[opcode],
-			      mem_get_byte(cpu_get_HL()) == 0x40 && cpu_get_F() == 0x10);
+			      mem_get_byte(gb, cpu_get_HL(gb)) == 0x40 && cpu_get_F(gb) == 0x10);
 
 	// 0x40 : BIT 0, B
 	opcode = 0x40;
-	cpu_reset_registers();
-	cpu_set_B(0x01);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x01);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x46 : BIT 0, (HL)
 	opcode = 0x46;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF0);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF0);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x48 : BIT 1, C
 	opcode = 0x49;
-	cpu_reset_registers();
-	cpu_set_C(0x02);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x02);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x4E : BIT 1, (HL)
 	opcode = 0x4E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF0);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF0);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x50 : BIT 2, B
 	opcode = 0x50;
-	cpu_reset_registers();
-	cpu_set_B(0x04);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x04);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x56 : BIT 2, (HL)
 	opcode = 0x56;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF0);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF0);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x58 : BIT 3, C
 	opcode = 0x59;
-	cpu_reset_registers();
-	cpu_set_C(0x08);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x08);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x5E : BIT 3, (HL)
 	opcode = 0x5E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xF0);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xF0);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x60 : BIT 4, B
 	opcode = 0x60;
-	cpu_reset_registers();
-	cpu_set_B(0x10);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x10);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x66 : BIT 4, (HL)
 	opcode = 0x66;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x0F);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x68 : BIT 5, C
 	opcode = 0x69;
-	cpu_reset_registers();
-	cpu_set_C(0x20);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x20);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x6E : BIT 5, (HL)
 	opcode = 0x6E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x0F);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x70 : BIT 6, B
 	opcode = 0x70;
-	cpu_reset_registers();
-	cpu_set_B(0x40);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x40);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x76 : BIT 6, (HL)
 	opcode = 0x76;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x0F);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x78 : BIT 7, C
 	opcode = 0x79;
-	cpu_reset_registers();
-	cpu_set_C(0x80);
+	cpu_reset_registers(gb);
+	cpu_set_C(gb, 0x80);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0x20);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0x20);
 
 	// 0x7E : BIT 7, (HL)
 	opcode = 0x7E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x0F);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x0F);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F() == 0xA0);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_F(gb) == 0xA0);
 
 	// 0x80 : RES 0, B
 	opcode = 0x80;
-	cpu_reset_registers();
-	cpu_set_B(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xFF);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0xFE);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0xFE);
 
 	// 0x86 : RES 0, (HL)
 	opcode = 0x86;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xFF);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xFF);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0xFE);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0xFE);
 
 	// 0x88 : RES 1, B
 	opcode = 0x88;
-	cpu_reset_registers();
-	cpu_set_B(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xFF);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0xFD);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0xFD);
 
 	// 0x8E : RES 1, (HL)
 	opcode = 0x8E;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xFF);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xFF);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0xFD);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0xFD);
 
 	// 0xB0 : RES 6, B
 	opcode = 0xB0;
-	cpu_reset_registers();
-	cpu_set_B(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xFF);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0xBF);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0xBF);
 
 	// 0xB6 : RES 6, (HL)
 	opcode = 0xB6;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xFF);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xFF);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0xBF);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0xBF);
 
 	// 0xB8 : RES 7, B
 	opcode = 0xB8;
-	cpu_reset_registers();
-	cpu_set_B(0xFF);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0xFF);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x7F);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x7F);
 
 	// 0xBE : RES 7, (HL)
 	opcode = 0xBE;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0xFF);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0xFF);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0x7F);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0x7F);
 
 	// 0xC0 : SET 0, B
 	opcode = 0xC0;
-	cpu_reset_registers();
-	cpu_set_B(0x00);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x00);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x01);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x01);
 
 	// 0xC6 : SET 0, (HL)
 	opcode = 0xC6;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x00);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0x01);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0x01);
 
 	// 0xC8 : SET 1, B
 	opcode = 0xC8;
-	cpu_reset_registers();
-	cpu_set_B(0x00);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x00);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x02);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x02);
 
 	// 0xCE : SET 1, (HL)
 	opcode = 0xCE;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x00);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0x02);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0x02);
 
 	// 0xF0 : SET 6, B
 	opcode = 0xF0;
-	cpu_reset_registers();
-	cpu_set_B(0x00);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x00);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x40);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x40);
 
 	// 0xF6 : SET 6, (HL)
 	opcode = 0xF6;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x00);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0x40);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0x40);
 
 	// 0xF8 : SET 7, B
 	opcode = 0xF8;
-	cpu_reset_registers();
-	cpu_set_B(0x00);
+	cpu_reset_registers(gb);
+	cpu_set_B(gb, 0x00);
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B() == 0x80);
+	cpu_print_test_result(opcode_dict_CB[opcode], cpu_get_B(gb) == 0x80);
 
 	// 0xFE : SET 7, (HL)
 	opcode = 0xFE;
-	cpu_reset_registers();
-	cpu_set_HL(0x4157);
-	mem_set_byte(cpu_get_HL(), 0x00);	
+	cpu_reset_registers(gb);
+	cpu_set_HL(gb, 0xC157);
+	mem_set_byte(gb, cpu_get_HL(gb), 0x00);	
 	cpu_test_opcode(opcode_dict_CB[opcode]);
-	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(0x4157) == 0x80);
+	cpu_print_test_result(opcode_dict_CB[opcode], mem_get_byte(gb, 0xC157) == 0x80);
 
 	return 0;
 }
@@ -3676,10 +3673,15 @@ int main()
 {
 	int ret = 0;
 
+	gb = gb_create();
+	if (!gb)
+		return -ENOMEM;
+
 	ret = testsuite_flags();
 
 	ret = testsuite_opcodes();
 	ret = testsuite_opcodes_CB();
 
+	gb_destroy(gb);
 	return ret;
 }
\ No newline at end of file